@@ -6,6 +6,8 @@
 #include "utils.h"
 #include "consistent_linked_list.h"
 
+using namespace std;
+
 const int N_TEST = 100;
 
 string test_case = "NULL";
@@ -18,7 +20,7 @@ void REQUIRE(bool b) {
 
 void push_back() {
     test_case = "push_back";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     vector<int> v = {};
     for (int i = 0; i < N_TEST; i++) {
         int rnd_number = rand(-1e3, 1e3);
@@ -31,7 +33,7 @@ void push_back() {
 
 void push_front() {
     test_case = "push_front";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     vector<int> v(N_TEST);
     for (int i = 0; i < N_TEST; i++) {
         int rnd_number = rand(-1e3, 1e3);
@@ -58,7 +60,7 @@ void push_front() {
 
 void pop_first() {
     test_case = "pop_first";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     fill_random(list, N_TEST, (int) -1e3, (int) 1e3);
     auto v = list.to_vector();
 
@@ -80,7 +82,7 @@ void pop_first() {
 
 void pop_last() {
     test_case = "pop_last";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     fill_random(list, N_TEST, 1, 100);
     auto v = list.to_vector();
 
@@ -102,7 +104,7 @@ void pop_last() {
 
 void front() {
     test_case = "front";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     const int BACK_NUMBER = 0;
     list.push_back(BACK_NUMBER);
     for (int i = 0; i < N_TEST - 1; ++i) {
@@ -116,7 +118,7 @@ void front() {
 
 void back() {
     test_case = "back";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     const int FRONT_NUMBER = 0;
     list.push_front(FRONT_NUMBER);
     for (int i = 0; i < N_TEST - 1; ++i) {
@@ -137,17 +139,17 @@ void end() {
 }
 
 void empty_from_vector() {
-    consistent_linked_list<int> list_from_vector(get_vec<int>({}));
+    single_threaded::consistent_linked_list<int> list_from_vector(get_vec<int>({}));
     REQUIRE(list_from_vector.empty());
     list_from_vector.push_back(1);
     REQUIRE(!list_from_vector.empty());
 
-    consistent_linked_list<int> list_from_vector_not_empty(get_vec({1, 2, 3}));
+    single_threaded::consistent_linked_list<int> list_from_vector_not_empty(get_vec({1, 2, 3}));
     REQUIRE(!list_from_vector_not_empty.empty());
 }
 
 void empty_push_and_pop() {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     REQUIRE(list.empty());
 
     for (int i = 0; i < N_TEST; ++i) {
@@ -160,7 +162,7 @@ void empty_push_and_pop() {
 }
 
 void empty_push_then_pop() {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
 
     for (int i = 0; i < N_TEST; ++i) {
         list.push_back(i);
@@ -176,7 +178,7 @@ void empty_push_then_pop() {
 
 void size() {
     test_case = "size";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     REQUIRE(list.size() == 0);
     for (int i = 0; i < N_TEST; ++i) {
         list.push_back(0);
@@ -191,7 +193,7 @@ void size() {
 
 void size_random() {
     test_case = "size_random";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     REQUIRE(list.size() == 0);
     int real_size = 0;
     for (int i = 0; i < N_TEST; ++i) {
@@ -210,7 +212,7 @@ void size_random() {
 
 void erase() {
     test_case = "erase";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
 
     fill_range(list, 0, N_TEST - 1);
 
@@ -224,7 +226,7 @@ void erase() {
 
 void find() {
     test_case = "find";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     for (int i = 0; i < N_TEST; ++i) {
         REQUIRE(list.find(i) == list.end());
     }
@@ -245,7 +247,7 @@ void find() {
 
 void contain() {
     test_case = "contain";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     for (int i = 0; i < N_TEST; ++i) {
         REQUIRE(!list.contain(i));
     }
@@ -263,7 +265,7 @@ void contain() {
 
 void to_vector() {
     test_case = "to_vector";
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     vector<int> v;
 
     for (int i = 0; i < N_TEST; ++i) {
@@ -18,7 +18,7 @@ vector<T> get_vec(const initializer_list<T> &list) {
 }
 
 template<typename T>
-void fill_range(consistent_linked_list<T> &list, const T &left, const T &right) {
+void fill_range(single_threaded::consistent_linked_list<T> &list, const T &left, const T &right) {
     for (int i = left; i <= right; ++i) {
         list.push_back(i);
     }
@@ -30,14 +30,14 @@ T rand(const T &left, const T &right) {
 }
 
 template<typename T>
-void fill_random(consistent_linked_list<T> &list, const int &n, const T &left, const T &right) {
+void fill_random(single_threaded::consistent_linked_list<T> &list, const int &n, const T &left, const T &right) {
     for (int i = 0; i < n; ++i) {
         list.push_back(rand(left, right));
     }
 }
 
 TEST_CASE("push_back") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     vector<int> v = {};
     for (int i = 0; i < N_TEST; i++) {
         int rnd_number = rand(-1e3, 1e3);
@@ -49,7 +49,7 @@ TEST_CASE("push_back") {
 }
 
 TEST_CASE("push_front") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     vector<int> v(N_TEST);
     for (int i = 0; i < N_TEST; i++) {
         int rnd_number = rand(-1e3, 1e3);
@@ -76,7 +76,7 @@ TEST_CASE("push_front") {
 }
 
 TEST_CASE("pop_first") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     fill_random(list, N_TEST, (int) -1e3, (int) 1e3);
     auto v = list.to_vector();
 
@@ -97,7 +97,7 @@ TEST_CASE("pop_first") {
 }
 
 TEST_CASE("pop_last") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     fill_random(list, N_TEST, 1, 100);
     auto v = list.to_vector();
 
@@ -118,7 +118,7 @@ TEST_CASE("pop_last") {
 }
 
 TEST_CASE("front") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     const int BACK_NUMBER = 0;
     list.push_back(BACK_NUMBER);
     for (int i = 0; i < N_TEST - 1; ++i) {
@@ -131,7 +131,7 @@ TEST_CASE("front") {
 }
 
 TEST_CASE("back") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     const int FRONT_NUMBER = 0;
     list.push_front(FRONT_NUMBER);
     for (int i = 0; i < N_TEST - 1; ++i) {
@@ -152,17 +152,17 @@ TEST_CASE("end") {
 }
 
 TEST_CASE("empty from vector") {
-    consistent_linked_list<int> list_from_vector(get_vec<int>({}));
+    single_threaded::consistent_linked_list<int> list_from_vector(get_vec<int>({}));
     REQUIRE(list_from_vector.empty());
     list_from_vector.push_back(1);
     REQUIRE(!list_from_vector.empty());
 
-    consistent_linked_list<int> list_from_vector_not_empty(get_vec({1, 2, 3}));
+    single_threaded::consistent_linked_list<int> list_from_vector_not_empty(get_vec({1, 2, 3}));
     REQUIRE(!list_from_vector_not_empty.empty());
 }
 
 TEST_CASE("empty push and pop") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     REQUIRE(list.empty());
 
     for (int i = 0; i < N_TEST; ++i) {
@@ -175,7 +175,7 @@ TEST_CASE("empty push and pop") {
 }
 
 TEST_CASE("empty push, then pop") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     for (int i = 0; i < N_TEST; ++i) {
         list.push_back(i);
         REQUIRE(!list.empty());
@@ -189,7 +189,7 @@ TEST_CASE("empty push, then pop") {
 }
 
 TEST_CASE("size") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     REQUIRE(list.size() == 0);
     for (int i = 0; i < N_TEST; ++i) {
         list.push_back(0);
@@ -203,7 +203,7 @@ TEST_CASE("size") {
 }
 
 TEST_CASE("size_random") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     REQUIRE(list.size() == 0);
     int real_size = 0;
     for (int i = 0; i < N_TEST; ++i) {
@@ -221,7 +221,7 @@ TEST_CASE("size_random") {
 }
 
 TEST_CASE("erase") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
 
     fill_range(list, 0, N_TEST - 1);
 
@@ -233,7 +233,7 @@ TEST_CASE("erase") {
 }
 
 TEST_CASE("find") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     for (int i = 0; i < N_TEST; ++i) {
         REQUIRE(list.find(i) == list.end());
     }
@@ -253,7 +253,7 @@ TEST_CASE("find") {
 }
 
 TEST_CASE("contain") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     for (int i = 0; i < N_TEST; ++i) {
         REQUIRE(!list.contain(i));
     }
@@ -270,7 +270,7 @@ TEST_CASE("contain") {
 }
 
 TEST_CASE("to_vector") {
-    consistent_linked_list<int> list;
+    single_threaded::consistent_linked_list<int> list;
     vector<int> v;
 
     for (int i = 0; i < N_TEST; ++i) {
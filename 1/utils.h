@@ -10,7 +10,7 @@ std::vector<T> get_vec(const std::initializer_list<T> &list) {
 }
 
 template<typename T>
-void fill_range(consistent_linked_list<T> &list, const T &left, const T &right) {
+void fill_range(single_threaded::consistent_linked_list<T> &list, const T &left, const T &right) {
     for (int i = left; i <= right; ++i) {
         list.push_back(i);
     }
@@ -22,7 +22,7 @@ T rand(const T &left, const T &right) {
 }
 
 template<typename T>
-void fill_random(consistent_linked_list<T> &list, const int &n, const T &left, const T &right) {
+void fill_random(single_threaded::consistent_linked_list<T> &list, const int &n, const T &left, const T &right) {
     for (int i = 0; i < n; ++i) {
         T rnd_number = rand(left, right);
         list.push_back(rnd_number);
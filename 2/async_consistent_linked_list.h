@@ -0,0 +1,320 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "consistent_linked_list.h"
+
+template<typename T>
+class async_generator {
+public:
+    class promise_type {
+    public:
+        std::optional<T> current;
+        std::coroutine_handle<> consumer;
+        std::exception_ptr error;
+
+        // Suspends the generator and continues the consumer waiting in next().
+        class yield_awaiter {
+        public:
+            bool await_ready() noexcept {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                return h.promise().consumer;
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        async_generator get_return_object() {
+            return async_generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        yield_awaiter final_suspend() noexcept {
+            return {};
+        }
+
+        yield_awaiter yield_value(T value) {
+            current = std::move(value);
+            return {};
+        }
+
+        void return_void() {
+            current.reset();
+        }
+
+        void unhandled_exception() {
+            error = std::current_exception();
+            current.reset();
+        }
+    };
+
+    class next_awaiter {
+    private:
+        std::coroutine_handle<promise_type> gen;
+
+    public:
+        explicit next_awaiter(std::coroutine_handle<promise_type> gen_) : gen(gen_) {}
+
+        bool await_ready() noexcept {
+            return gen.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+            gen.promise().consumer = consumer;
+            return gen;
+        }
+
+        // Empty once the generator has finished.
+        std::optional<T> await_resume() {
+            auto &promise = gen.promise();
+            if (promise.error) {
+                std::rethrow_exception(promise.error);
+            }
+            return std::exchange(promise.current, std::nullopt);
+        }
+    };
+
+    explicit async_generator(std::coroutine_handle<promise_type> gen_) : gen(gen_) {}
+
+    async_generator(async_generator &&other) noexcept : gen(std::exchange(other.gen, nullptr)) {}
+
+    async_generator(const async_generator &) = delete;
+
+    ~async_generator() {
+        if (gen) {
+            gen.destroy();
+        }
+    }
+
+    next_awaiter next() {
+        return next_awaiter(gen);
+    }
+
+private:
+    std::coroutine_handle<promise_type> gen;
+};
+
+// consistent_linked_list for coroutine consumers. A consumer that finds the
+// list empty is parked as a coroutine handle, and the push that makes the
+// list non-empty resumes it, so no thread has to block per consumer.
+template<typename T>
+class async_consistent_linked_list {
+private:
+    class waiter {
+    public:
+        std::coroutine_handle<> handle;
+        bool wants_value = false;
+        std::optional<T> value;
+        // In waiters. Guarded by waiters_m.
+        bool is_parked = false;
+    };
+
+    consistent_linked_list<T> list;
+
+    std::mutex waiters_m;
+    std::deque<waiter *> waiters;
+    std::atomic<size_t> n_waiters{0};
+
+    // Resumes parked consumers; runs them inline on the pushing thread by default.
+    std::function<void(std::coroutine_handle<>)> executor;
+
+    // Returns false if the waiter was satisfied without suspending.
+    bool park(waiter *w) {
+        std::lock_guard<std::mutex> lock(waiters_m);
+        n_waiters.fetch_add(1);
+        if (w->wants_value) {
+            w->value = list.pop_first_value();
+            if (w->value) {
+                n_waiters.fetch_sub(1);
+                return false;
+            }
+        } else if (!list.empty()) {
+            n_waiters.fetch_sub(1);
+            return false;
+        }
+        waiters.push_back(w);
+        w->is_parked = true;
+        return true;
+    }
+
+    // The coroutine awaiting w was destroyed while parked, e.g. a consumer
+    // dropping the async_elements() stream: it must not be resumed.
+    void cancel(waiter *w) {
+        std::lock_guard<std::mutex> lock(waiters_m);
+        if (!w->is_parked) {
+            return;
+        }
+        for (auto it = waiters.begin(); it != waiters.end(); ++it) {
+            if (*it == w) {
+                waiters.erase(it);
+                break;
+            }
+        }
+        w->is_parked = false;
+        n_waiters.fetch_sub(1);
+    }
+
+    void wake_waiters() {
+        if (n_waiters.load() == 0) {
+            return;
+        }
+
+        std::vector<std::coroutine_handle<>> ready;
+        waiters_m.lock();
+        while (!waiters.empty()) {
+            waiter *w = waiters.front();
+            if (w->wants_value) {
+                w->value = list.pop_first_value();
+                if (!w->value) {
+                    break;
+                }
+            } else if (list.empty()) {
+                break;
+            }
+            waiters.pop_front();
+            w->is_parked = false;
+            n_waiters.fetch_sub(1);
+            ready.push_back(w->handle);
+        }
+        waiters_m.unlock();
+
+        for (auto h : ready) {
+            resume(h);
+        }
+    }
+
+    void resume(std::coroutine_handle<> h) {
+        if (executor) {
+            executor(h);
+        } else {
+            h.resume();
+        }
+    }
+
+public:
+    class pop_awaiter {
+    private:
+        async_consistent_linked_list<T> *base_list;
+        waiter w;
+
+    public:
+        explicit pop_awaiter(async_consistent_linked_list<T> *base_list_) : base_list(base_list_) {
+            w.wants_value = true;
+        }
+
+        pop_awaiter(const pop_awaiter &) = delete;
+
+        // Only an awaiter that went through await_suspend can be parked.
+        ~pop_awaiter() {
+            if (w.handle) {
+                base_list->cancel(&w);
+            }
+        }
+
+        bool await_ready() {
+            w.value = base_list->list.try_pop_first();
+            return w.value.has_value();
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            w.handle = h;
+            return base_list->park(&w);
+        }
+
+        T await_resume() {
+            return std::move(*w.value);
+        }
+    };
+
+    class nonempty_awaiter {
+    private:
+        async_consistent_linked_list<T> *base_list;
+        waiter w;
+
+    public:
+        explicit nonempty_awaiter(async_consistent_linked_list<T> *base_list_) : base_list(base_list_) {}
+
+        nonempty_awaiter(const nonempty_awaiter &) = delete;
+
+        ~nonempty_awaiter() {
+            if (w.handle) {
+                base_list->cancel(&w);
+            }
+        }
+
+        bool await_ready() {
+            return !base_list->list.empty();
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            w.handle = h;
+            return base_list->park(&w);
+        }
+
+        void await_resume() {}
+    };
+
+    async_consistent_linked_list() = default;
+
+    explicit async_consistent_linked_list(std::function<void(std::coroutine_handle<>)> executor_) :
+            executor(std::move(executor_)) {}
+
+    void push_back(const T &value) {
+        list.push_back(value);
+        wake_waiters();
+    }
+
+    void push_front(const T &value) {
+        list.push_front(value);
+        wake_waiters();
+    }
+
+    pop_awaiter async_pop_first() {
+        return pop_awaiter(this);
+    }
+
+    nonempty_awaiter async_wait_nonempty() {
+        return nonempty_awaiter(this);
+    }
+
+    // Endless stream: every element is popped and handed to the consumer as it arrives.
+    async_generator<T> async_elements() {
+        while (true) {
+            co_yield co_await async_pop_first();
+        }
+    }
+
+    std::optional<T> pop_first_value() {
+        return list.pop_first_value();
+    }
+
+    bool empty() {
+        return list.empty();
+    }
+
+    size_t size() {
+        return list.size();
+    }
+
+    std::vector<T> to_vector() {
+        return list.to_vector();
+    }
+
+    size_t waiting_consumers() {
+        return n_waiters.load();
+    }
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "iostream"
+#include "vector"
+#include <coroutine>
+#include <thread>
+
+#include "async_consistent_linked_list.h"
+
+namespace async_list_tests {
+    using namespace std;
+
+    const int N_TEST = 100;
+    int N_THREADS = 4;
+
+    string test_case = "NULL";
+
+    void REQUIRE(bool b) {
+        if (!b) {
+            throw runtime_error("Fail. Test: " + test_case);
+        }
+    }
+
+    // Fire-and-forget coroutine, starts eagerly and frees itself at the end.
+    class task {
+    public:
+        class promise_type {
+        public:
+            task get_return_object() {
+                return {};
+            }
+
+            suspend_never initial_suspend() noexcept {
+                return {};
+            }
+
+            suspend_never final_suspend() noexcept {
+                return {};
+            }
+
+            void return_void() {}
+
+            void unhandled_exception() {
+                terminate();
+            }
+        };
+    };
+
+    task consume(async_consistent_linked_list<int> &list, vector<int> &out, int n) {
+        for (int i = 0; i < n; ++i) {
+            out.push_back(co_await list.async_pop_first());
+        }
+    }
+
+    task wait_nonempty(async_consistent_linked_list<int> &list, bool &woken) {
+        co_await list.async_wait_nonempty();
+        woken = true;
+    }
+
+    task consume_elements(async_consistent_linked_list<int> &list, vector<int> &out, int n) {
+        auto elements = list.async_elements();
+        for (int i = 0; i < n; ++i) {
+            auto v = co_await elements.next();
+            out.push_back(*v);
+        }
+    }
+
+    void pop_first() {
+        test_case = "pop_first";
+
+        async_consistent_linked_list<int> list;
+        list.push_back(-1);
+
+        vector<int> out;
+        consume(list, out, N_TEST + 1);
+        REQUIRE(out.size() == 1);
+        REQUIRE(list.waiting_consumers() == 1);
+
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+            REQUIRE(out.back() == i);
+        }
+        REQUIRE(out.size() == N_TEST + 1);
+        REQUIRE(list.waiting_consumers() == 0);
+        REQUIRE(list.empty());
+    }
+
+    void async_wait_nonempty() {
+        test_case = "async_wait_nonempty";
+
+        async_consistent_linked_list<int> list;
+        bool woken = false;
+        wait_nonempty(list, woken);
+        REQUIRE(!woken);
+
+        list.push_front(1);
+        REQUIRE(woken);
+        REQUIRE(list.size() == 1);
+    }
+
+    void async_elements() {
+        test_case = "async_elements";
+
+        async_consistent_linked_list<int> list;
+        vector<int> out;
+        consume_elements(list, out, N_TEST);
+
+        vector<int> v;
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+            v.push_back(i);
+        }
+        REQUIRE(out == v);
+        REQUIRE(list.empty());
+    }
+
+    void destroy_parked() {
+        test_case = "destroy_parked";
+
+        async_consistent_linked_list<int> list;
+        {
+            auto elements = list.async_elements();
+            // Runs the generator until it parks on the empty list.
+            auto next = elements.next();
+            next.await_suspend(noop_coroutine()).resume();
+            REQUIRE(list.waiting_consumers() == 1);
+        }
+        REQUIRE(list.waiting_consumers() == 0);
+
+        // Nobody is left to take it, so it stays in the list.
+        list.push_back(1);
+        REQUIRE(list.size() == 1);
+    }
+
+    void threads_push() {
+        test_case = "threads_push";
+
+        async_consistent_linked_list<int> list;
+        vector<int> out;
+        consume(list, out, N_THREADS * N_TEST);
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    list.push_back(i * N_TEST + j);
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(out.size() == (size_t) (N_THREADS * N_TEST));
+        sort(out.begin(), out.end());
+        for (int i = 0; i < N_THREADS * N_TEST; ++i) {
+            REQUIRE(out[i] == i);
+        }
+    }
+
+    void start() {
+        pop_first();
+        async_wait_nonempty();
+        async_elements();
+        destroy_parked();
+        threads_push();
+
+        std::cout << "Async list tests passed. Nice!" << endl;
+    }
+}
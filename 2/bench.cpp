@@ -0,0 +1,7 @@
+#include "benchmarks.h"
+
+int main() {
+    benchmarks::start();
+
+    return 0;
+}
@@ -0,0 +1,522 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "consistent_linked_list.h"
+#include "elimination_list.h"
+#include "flat_combining_list.h"
+#include "mpsc_consistent_linked_list.h"
+#include "node_arena.h"
+#include "spsc_consistent_linked_list.h"
+
+// mutex_lock with the list fields left unpadded, to measure what the
+// cache line padding buys.
+class unpadded_mutex : public mutex_lock {
+};
+
+template<>
+struct cache_line_padding<unpadded_mutex> {
+    static constexpr size_t value = 0;
+};
+
+namespace benchmarks {
+    using namespace std;
+
+    const vector<int> THREAD_COUNTS = {1, 2, 4, 8, 16, 32, 64};
+    int N_OPS = 200000;
+
+    // Runs f(thread_index, n_ops) on n_threads threads and returns total ops per second.
+    template<typename F>
+    double ops_per_sec(int n_threads, int n_ops, F f) {
+        vector<thread> vt(n_threads);
+        int per_thread = n_ops / n_threads;
+
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < n_threads; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                f(i, per_thread);
+            });
+        }
+        for (int i = 0; i < n_threads; ++i) {
+            vt[i].join();
+        }
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        return per_thread * n_threads / elapsed.count();
+    }
+
+    void print_header(const string &name, const vector<string> &columns) {
+        cout << name << endl;
+        cout << setw(8) << "threads";
+        for (auto &c : columns) {
+            cout << setw(16) << c;
+        }
+        cout << endl;
+    }
+
+    void print_row(int n_threads, const vector<double> &values) {
+        cout << setw(8) << n_threads;
+        for (double v : values) {
+            cout << setw(16) << fixed << setprecision(0) << v;
+        }
+        cout << endl;
+    }
+
+    template<typename List>
+    void mixed_ops(List &list, int thread_index, int n_ops) {
+        for (int j = 0; j < n_ops; ++j) {
+            switch ((thread_index + j) % 4) {
+                case 0:
+                    list.push_back(j);
+                    break;
+                case 1:
+                    list.push_front(j);
+                    break;
+                case 2:
+                    list.pop_first();
+                    break;
+                default:
+                    list.pop_last();
+            }
+        }
+    }
+
+    void flat_combining() {
+        print_header("push/pop ops/sec: mutex vs flat combining", {"mutex", "combining"});
+        for (int n_threads : THREAD_COUNTS) {
+            consistent_linked_list<int> locked;
+            flat_combining_list<int> combined;
+
+            double a = ops_per_sec(n_threads, N_OPS, [&](int i, int n) { mixed_ops(locked, i, n); });
+            double b = ops_per_sec(n_threads, N_OPS, [&](int i, int n) { mixed_ops(combined, i, n); });
+            print_row(n_threads, {a, b});
+        }
+        cout << endl;
+    }
+
+    void elimination() {
+        print_header("push_front/pop_first ops/sec: mutex vs elimination", {"mutex", "elimination"});
+        for (int n_threads : THREAD_COUNTS) {
+            consistent_linked_list<int> locked;
+            elimination_list<int> eliminating;
+
+            double a = ops_per_sec(n_threads, N_OPS, [&](int i, int n) {
+                for (int j = 0; j < n; ++j) {
+                    if ((i + j) % 2) {
+                        locked.push_front(j);
+                    } else {
+                        locked.pop_first_value();
+                    }
+                }
+            });
+            double b = ops_per_sec(n_threads, N_OPS, [&](int i, int n) {
+                for (int j = 0; j < n; ++j) {
+                    if ((i + j) % 2) {
+                        eliminating.push_front(j);
+                    } else {
+                        eliminating.pop_first();
+                    }
+                }
+            });
+            print_row(n_threads, {a, b});
+        }
+        cout << endl;
+    }
+
+    // One producer pushes n values, one consumer pops them; returns ops per second.
+    template<typename List>
+    double producer_consumer(List &list, int n) {
+        auto start = chrono::steady_clock::now();
+        thread producer([&]() -> void {
+            for (int i = 0; i < n; ++i) {
+                list.push_back(i);
+            }
+        });
+        thread consumer([&]() -> void {
+            for (int i = 0; i < n;) {
+                if (list.pop_first_value()) {
+                    i++;
+                }
+            }
+        });
+        producer.join();
+        consumer.join();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        return 2 * n / elapsed.count();
+    }
+
+    void spsc() {
+        print_header("push_back/pop_first ops/sec, one producer and one consumer", {"mutex", "spsc"});
+        consistent_linked_list<int> locked;
+        spsc_consistent_linked_list<int> wait_free;
+
+        double a = producer_consumer(locked, N_OPS);
+        double b = producer_consumer(wait_free, N_OPS);
+        print_row(2, {a, b});
+        cout << endl;
+    }
+
+    void mpsc() {
+        print_header("log ingestion ops/sec, n producers and one draining consumer", {"mutex", "mpsc"});
+        for (int n_threads : THREAD_COUNTS) {
+            int per_thread = N_OPS / n_threads;
+            int total = per_thread * n_threads;
+            vector<double> row;
+
+            for (int kind = 0; kind < 2; ++kind) {
+                consistent_linked_list<int> locked;
+                mpsc_consistent_linked_list<int> queue;
+
+                auto start = chrono::steady_clock::now();
+                vector<thread> vt(n_threads);
+                for (int i = 0; i < n_threads; ++i) {
+                    vt[i] = thread([&]() -> void {
+                        for (int j = 0; j < per_thread; ++j) {
+                            if (kind == 0) {
+                                locked.push_back(j);
+                            } else {
+                                queue.push_back(j);
+                            }
+                        }
+                    });
+                }
+                vector<int> batch;
+                for (int done = 0; done < total;) {
+                    if (kind == 0) {
+                        if (locked.pop_first_value()) {
+                            done++;
+                        }
+                    } else {
+                        batch.clear();
+                        done += queue.drain_all(batch);
+                    }
+                }
+                for (int i = 0; i < n_threads; ++i) {
+                    vt[i].join();
+                }
+                chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+                row.push_back(2 * total / elapsed.count());
+            }
+            print_row(n_threads, row);
+        }
+        cout << endl;
+    }
+
+    template<typename List>
+    double single_thread_ns_per_op(int n) {
+        auto start = chrono::steady_clock::now();
+        long long checksum = 0;
+        {
+            List list;
+            for (int i = 0; i < n; ++i) {
+                list.push_back(i);
+                list.push_front(i);
+            }
+            for (int i = 0; i < 8; ++i) {
+                checksum += list.contain(-1);
+            }
+            for (int i = 0; i < n; ++i) {
+                list.pop_first();
+                list.pop_last();
+            }
+        }
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        if (checksum != 0) {
+            cout << "unexpected element" << endl;
+        }
+        return elapsed.count() / (4.0 * n + 8.0 * 2 * n);
+    }
+
+    void null_policy() {
+        cout << "single thread ns/op by lock policy" << endl;
+        cout << setw(24) << "null_lock" << setw(12) << fixed << setprecision(2)
+             << single_thread_ns_per_op<consistent_linked_list<int, null_lock>>(N_OPS) << endl;
+        cout << setw(24) << "mutex_lock" << setw(12)
+             << single_thread_ns_per_op<consistent_linked_list<int, mutex_lock>>(N_OPS) << endl;
+        cout << setw(24) << "spin_lock" << setw(12)
+             << single_thread_ns_per_op<consistent_linked_list<int, spin_lock>>(N_OPS) << endl;
+        cout << endl;
+    }
+
+    template<typename F>
+    double ns_per_call(int n, F f) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+            f();
+        }
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        return elapsed.count() / n;
+    }
+
+    // Cost of hitting an empty list or end(): exception vs optional/bool result.
+    void boundary_checks() {
+        consistent_linked_list<int> list;
+        auto it = list.end();
+        long long misses = 0;
+
+        cout << "ns per boundary hit" << endl;
+        cout << setw(24) << "front() throws" << setw(12) << fixed << setprecision(2)
+             << ns_per_call(N_OPS / 10, [&] {
+                 try {
+                     list.front();
+                 } catch (const consistent_linked_list_exception &) {
+                     misses++;
+                 }
+             }) << endl;
+        cout << setw(24) << "front_value()" << setw(12)
+             << ns_per_call(N_OPS, [&] { misses += !list.front_value(); }) << endl;
+        cout << setw(24) << "++end() throws" << setw(12)
+             << ns_per_call(N_OPS / 10, [&] {
+                 try {
+                     ++it;
+                 } catch (const consistent_linked_list_exception &) {
+                     misses++;
+                 }
+             }) << endl;
+        cout << setw(24) << "move_next()" << setw(12)
+             << ns_per_call(N_OPS, [&] { misses += !it.move_next(); }) << endl;
+        if (misses != N_OPS / 10 * 2 + N_OPS * 2) {
+            cout << "unexpected element" << endl;
+        }
+        cout << endl;
+    }
+
+    // Erasing every other element: erase(it) per element vs one erase_if pass.
+    void purge() {
+        cout << "ms to purge half of " << N_OPS << " elements" << endl;
+        {
+            consistent_linked_list<int> list;
+            for (int i = 0; i < N_OPS; ++i) {
+                list.push_back(i);
+            }
+            auto start = chrono::steady_clock::now();
+            for (auto it = list.begin(); it != list.end();) {
+                auto current = it++;
+                if (*current % 2 == 0) {
+                    list.erase(current);
+                }
+            }
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            cout << setw(24) << "erase(it) loop" << setw(12) << elapsed.count() << endl;
+        }
+        {
+            consistent_linked_list<int> list;
+            for (int i = 0; i < N_OPS; ++i) {
+                list.push_back(i);
+            }
+            auto start = chrono::steady_clock::now();
+            list.erase_if([](int v) { return v % 2 == 0; });
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            cout << setw(24) << "erase_if" << setw(12) << elapsed.count() << endl;
+        }
+        cout << endl;
+    }
+
+    // Erasing m values: erase(value) per value vs one erase_all pass.
+    void bulk_erase() {
+        const int M = 2000;
+        vector<int> values;
+        for (int i = 0; i < M; ++i) {
+            values.push_back(i * (N_OPS / M));
+        }
+
+        cout << "ms to erase " << M << " values from " << N_OPS << " elements" << endl;
+        {
+            consistent_linked_list<int> list;
+            for (int i = 0; i < N_OPS; ++i) {
+                list.push_back(i);
+            }
+            auto start = chrono::steady_clock::now();
+            for (int v : values) {
+                list.erase(v);
+            }
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            cout << setw(24) << "erase(value) loop" << setw(12) << elapsed.count() << endl;
+        }
+        {
+            consistent_linked_list<int> list;
+            for (int i = 0; i < N_OPS; ++i) {
+                list.push_back(i);
+            }
+            auto start = chrono::steady_clock::now();
+            list.erase_all(values);
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            cout << setw(24) << "erase_all" << setw(12) << elapsed.count() << endl;
+        }
+        cout << endl;
+    }
+
+    const int N_SCAN = 4000000;
+
+    // Fills list with 0..n-1, far more than the last level cache holds, with
+    // the nodes scattered so that every hop is a cache miss.
+    template<typename List>
+    void fill_scattered(List &list, int n) {
+        const int N_PARTS = 4096;
+        vector<List> parts(N_PARTS);
+        size_t seed = 1;
+        for (int i = 0; i < n; ++i) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            parts[(seed >> 33) % N_PARTS].push_back(i);
+        }
+        for (auto &part : parts) {
+            list.splice(list.end(), part);
+        }
+    }
+
+    void scan() {
+        consistent_linked_list<int> list;
+        fill_scattered(list, N_SCAN);
+
+        // Stored so that the scans are not optimized out.
+        volatile size_t sink = 0;
+        auto ns_per_element = [&](auto &&f) {
+            auto start = chrono::steady_clock::now();
+            sink = f();
+            chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+            return elapsed.count() / N_SCAN;
+        };
+
+        cout << "ns per element to scan " << N_SCAN << " scattered elements" << endl;
+        cout << setw(24) << "one end (find_if_from)" << setw(12) << ns_per_element([&] {
+            return list.find_if_from(list.begin(), [](int v) { return v < 0; }).is_end();
+        }) << endl;
+        cout << setw(24) << "both ends (contain)" << setw(12) << ns_per_element([&] {
+            return list.contain(-1);
+        }) << endl;
+        cout << setw(24) << "to_vector" << setw(12) << ns_per_element([&] {
+            return list.to_vector().size();
+        }) << endl;
+        cout << setw(24) << "iterator" << setw(12) << ns_per_element([&] {
+            size_t n = 0;
+            for (auto it = list.begin(); it.move_next();) {
+                n++;
+            }
+            return n;
+        }) << endl;
+        cout << endl;
+    }
+
+    // Every thread works on a list of its own, in a vector, so any slowdown
+    // of the unpadded lists against the padded ones is false sharing.
+    void false_sharing() {
+        auto own_list_ops = [](auto &list, int n) {
+            for (int j = 0; j < n; ++j) {
+                list.push_back(j);
+                list.pop_first();
+            }
+        };
+
+        print_header("push_back/pop_first ops/sec, one list per thread", {"padded", "unpadded"});
+        for (int n_threads : THREAD_COUNTS) {
+            vector<consistent_linked_list<int>> padded(n_threads);
+            vector<consistent_linked_list<int, unpadded_mutex>> unpadded(n_threads);
+
+            double a = ops_per_sec(n_threads, N_OPS, [&](int i, int n) { own_list_ops(padded[i], n); });
+            double b = ops_per_sec(n_threads, N_OPS, [&](int i, int n) { own_list_ops(unpadded[i], n); });
+            print_row(n_threads, {a, b});
+        }
+        cout << endl;
+    }
+
+    template<typename List>
+    double contain_ns_per_element(List &list) {
+        auto start = chrono::steady_clock::now();
+        volatile bool found = list.contain(-1);
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        return found ? 0 : elapsed.count() / list.size();
+    }
+
+    void huge_pages() {
+        consistent_linked_list<int> heap_list;
+        consistent_linked_list<int, mutex_lock, plain_ref_count, huge_page_arena> arena_list;
+        fill_scattered(heap_list, N_SCAN);
+        fill_scattered(arena_list, N_SCAN);
+
+        cout << "ns per element, contain over " << N_SCAN << " scattered elements" << endl;
+        cout << setw(24) << "heap" << setw(12) << contain_ns_per_element(heap_list) << endl;
+        cout << setw(24) << "huge page arena" << setw(12) << contain_ns_per_element(arena_list) << endl;
+        cout << setw(24) << "nodes on huge pages" << setw(12) << arena_list.nodes_on_huge_pages() << endl;
+        cout << endl;
+    }
+
+    // Resident set size from /proc/self/statm, 0 where there is none.
+    double rss_mb() {
+        ifstream statm("/proc/self/statm");
+        size_t pages = 0;
+        size_t resident = 0;
+        statm >> pages >> resident;
+        return resident * 4096.0 / (1 << 20);
+    }
+
+    template<typename List>
+    void trim_with(const string &name) {
+        const int N_SPIKE = 2000000;
+        const int N_KEPT = 1000;
+        List list;
+        double before = rss_mb();
+        for (int i = 0; i < N_SPIKE; ++i) {
+            list.push_back(i);
+        }
+        double spike = rss_mb();
+        list.erase_if([](int v) { return v >= N_KEPT; });
+        double shrunk = rss_mb();
+        list.trim();
+        double trimmed = rss_mb();
+        cout << setw(24) << name << fixed << setprecision(1) << setw(12) << before << setw(12) << spike
+             << setw(12) << shrunk << setw(12) << trimmed << endl;
+    }
+
+    void trim() {
+        cout << "RSS in MB: push 2000000 elements, erase all but 1000, trim()" << endl;
+        cout << setw(24) << "" << setw(12) << "before" << setw(12) << "pushed" << setw(12) << "erased"
+             << setw(12) << "trimmed" << endl;
+        trim_with<consistent_linked_list<int>>("heap");
+        trim_with<consistent_linked_list<int, mutex_lock, plain_ref_count, huge_page_arena>>("huge page arena");
+        cout << endl;
+    }
+
+    template<typename LockPolicy>
+    double mixed_ops_with(int n_threads) {
+        consistent_linked_list<int, LockPolicy> list;
+        return ops_per_sec(n_threads, N_OPS, [&](int i, int n) { mixed_ops(list, i, n); });
+    }
+
+    void lock_matrix() {
+        print_header("push/pop ops/sec by lock policy",
+                     {"mutex", "spin", "adaptive", "ticket", "mcs", "contention"});
+        for (int n_threads : THREAD_COUNTS) {
+            print_row(n_threads, {
+                    mixed_ops_with<mutex_lock>(n_threads),
+                    mixed_ops_with<spin_lock>(n_threads),
+                    mixed_ops_with<adaptive_lock>(n_threads),
+                    mixed_ops_with<ticket_lock>(n_threads),
+                    mixed_ops_with<mcs_lock>(n_threads),
+                    mixed_ops_with<contention_adaptive_lock>(n_threads)});
+        }
+        cout << endl;
+    }
+
+    void start() {
+        null_policy();
+        boundary_checks();
+        purge();
+        bulk_erase();
+        scan();
+        huge_pages();
+        trim();
+        false_sharing();
+        flat_combining();
+        elimination();
+        spsc();
+        mpsc();
+        lock_matrix();
+    }
+}
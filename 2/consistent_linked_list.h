@@ -1,99 +1,768 @@
 #pragma once
 
 #include <iostream>
+#include <atomic>
 #include <vector>
+#include <chrono>
+#include <condition_variable>
 #include <exception>
+#include <functional>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
-class consistent_linked_list_exception : std::exception {
+#include "lock_policies.h"
+#include "node_arena.h"
+
+// Reasons are string literals, so throwing one does not allocate.
+class consistent_linked_list_exception : public std::exception {
 public:
-    std::string reason;
+    const char *reason;
 
-    consistent_linked_list_exception(const std::string &reason_) {
-        reason = reason_;
-    }
+    explicit consistent_linked_list_exception(const char *reason_) noexcept : reason(reason_) {}
 
-    char *what() {
-        return const_cast<char *>(reason.c_str());
+    const char *what() const noexcept override {
+        return reason;
     }
 };
 
-template<typename T>
+enum class capacity_unit {
+    elements,
+    // sizeof(Node) per element, memory owned by T itself is not counted.
+    bytes
+};
+
+enum class erase_mode {
+    // Each value is erased once, at its first occurrence.
+    first,
+    all
+};
+
+enum class list_status {
+    ok,
+    full,
+    timeout,
+    empty,
+    // The lock was taken and the call was not allowed to wait for it.
+    busy,
+    // The iterator has no element in the requested direction.
+    end
+};
+
+// LockPolicy guards every operation and is taken once per public call, so it
+// does not have to be recursive. Read-only calls take it shared when the
+// policy has lock_shared(). RefCountPolicy decides whether node reference
+// counts are plain or atomic integers. AllocationPolicy is where nodes live,
+// see node_arena.h.
+template<typename T, typename LockPolicy = mutex_lock, typename RefCountPolicy = plain_ref_count,
+        typename AllocationPolicy = heap_allocation>
 class consistent_linked_list {
+public:
+    class consistent_iterator;
+
 private:
     class Node {
     public:
-        Node(consistent_linked_list<T> *base_list_, const T &t) :
-                base_list(base_list_), value(t) {}
+        Node(consistent_linked_list *base_list_, const T &t) :
+                value(t), base_list(base_list_) {}
+
+        template<typename... Args>
+        Node(consistent_linked_list *base_list_, std::in_place_t, Args &&...args) :
+                value(std::forward<Args>(args)...), base_list(base_list_) {}
 
-        consistent_linked_list<T> *base_list;
+        static void *operator new(size_t) {
+            return AllocationPolicy::template allocate<sizeof(Node), alignof(Node)>();
+        }
+
+        static void operator delete(void *p) {
+            AllocationPolicy::template deallocate<sizeof(Node), alignof(Node)>(p);
+        }
+
+        // What scans read comes first, the fields iterators write come last.
         T value;
         Node *prev = nullptr;
         Node *next = nullptr;
 
+        // Changes when the node is spliced into another list, under both locks.
+        std::atomic<consistent_linked_list *> base_list;
         bool is_deleted = false;
-        int ref_count = 0;
+        // Unlinked while an iterator still pointed at it. A tombstone holds a
+        // reference on prev and next, so iterators can always walk off it.
+        // It only lives as long as an iterator does.
+        bool is_tombstone = false;
+        // Number of tombstones holding such a reference on this node.
+        int n_pins = 0;
+        typename RefCountPolicy::type ref_count{0};
+
+        consistent_linked_list *list() const {
+            return base_list.load(std::memory_order_relaxed);
+        }
 
         void add_ref_count(const int &value_) {
-            if (this == base_list->END_NODE) {
+            consistent_linked_list *base = list();
+            if (this == base->END_NODE) {
                 return;
             }
 
-            ref_count += value_;
-            if (ref_count <= 0) {
-                base_list->n_deleted_node++;
+            int left = RefCountPolicy::add(ref_count, value_);
+            if (is_tombstone && left <= n_pins) {
+                base->release_tombstone(this);
+                return;
+            }
+            if (left <= 0) {
+                base->n_deleted_node++;
 //                cout << "It's all, we deleted :( value = " << value << endl;
                 delete this;
             }
         }
     };
 
-    std::recursive_mutex m;
-
-    Node *END_NODE;
-
-    Node *first;
+    // Alignment that starts a member of type M on a new cache line, or just
+    // its own alignment when the policy is not padded.
+    template<typename M>
+    static constexpr size_t line_start = cache_line_padding<LockPolicy>::value > alignof(M) ?
+                                         cache_line_padding<LockPolicy>::value : alignof(M);
+
+    // The lock, the state it guards, the read-mostly fields and the ones
+    // written by waits and pins sit on separate cache lines. Waiters spinning
+    // on the lock do not keep invalidating the line the holder writes,
+    // iterators reading END_NODE are not hit by writes to the state, the
+    // condition variables or pinned_by, and neighbouring lists in an array
+    // do not share lines.
+    alignas(line_start<LockPolicy>) LockPolicy m;
+
+    alignas(line_start<Node *>) Node *first;
     Node *last;
-
     size_t list_size = 0;
+    size_t n_tombstones = 0;
+    // Consumers blocked in wait_pop_first()/pop_for(), pushes skip notify when 0.
+    size_t n_waiters = 0;
+    size_t n_push_waiters = 0;
+    // Set once the size goes above low_water_mark, see set_low_water_mark().
+    bool trim_armed = false;
+    // The size dropped back to low_water_mark, trim once m is released.
+    bool trim_due = false;
+
+    alignas(line_start<Node *>) Node *END_NODE;
+    // 0 means unbounded. Tombstones count too: their memory is still held.
+    size_t capacity = 0;
+    capacity_unit unit = capacity_unit::elements;
+    size_t low_water_mark = 0;
+
+    alignas(line_start<lock_condition<LockPolicy>>) lock_condition<LockPolicy> not_empty;
+    lock_condition<LockPolicy> not_full;
+    // Pinned node -> tombstone pinning it. Only as big as there are tombstones.
+    std::unordered_multimap<Node *, Node *> pinned_by;
 
     Node *create_new_node(const T &value) {
         return new Node(this, value);
     }
 
-    void remove_node(Node *node) {
-        if (node->is_deleted) return;
-
-        node->is_deleted = 1;
-
+    // Takes node out of the live chain, reference counts are left alone.
+    void unlink(Node *node) {
         Node *prev = node->prev;
         Node *next = node->next;
 
         prev->next = next;
         next->prev = prev;
 
+        if (node == first) {
+            first = next;
+        }
+        if (node == last) {
+            last = prev;
+        }
+
+        list_size--;
+    }
+
+    void pin(Node *node, Node *tombstone) {
+        node->n_pins++;
+        node->add_ref_count(1);
+        pinned_by.emplace(node, tombstone);
+    }
+
+    // Nodes no iterator points at are never kept for a tombstone: every
+    // tombstone leading to node is made to lead past it, to the neighbours
+    // node itself is linked to or pins. So a tombstone never pins another
+    // node that only tombstones keep, and what is held stays bounded by the
+    // number of iterators, whatever the traffic around them.
+    void forward_pins(Node *node) {
+        auto range = pinned_by.equal_range(node);
+        std::vector<Node *> tombstones;
+        for (auto it = range.first; it != range.second; ++it) {
+            tombstones.push_back(it->second);
+        }
+        pinned_by.erase(range.first, range.second);
+        for (Node *tombstone : tombstones) {
+            if (tombstone->prev == node) {
+                tombstone->prev = node->prev;
+                pin(node->prev, tombstone);
+            }
+            if (tombstone->next == node) {
+                tombstone->next = node->next;
+                pin(node->next, tombstone);
+            }
+        }
+        RefCountPolicy::add(node->ref_count, -node->n_pins);
+        node->n_pins = 0;
+    }
+
+    void unpin(Node *node, Node *tombstone) {
+        node->n_pins--;
+        auto range = pinned_by.equal_range(node);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == tombstone) {
+                pinned_by.erase(it);
+                break;
+            }
+        }
+    }
+
+    void remove_node(Node *node) {
+        if (node->is_deleted || node == END_NODE) return;
+
+        node->is_deleted = 1;
+
+        if (RefCountPolicy::load(node->ref_count) > 2 + node->n_pins) {
+            node->is_tombstone = true;
+            n_tombstones++;
+            pin(node->prev, node);
+            pin(node->next, node);
+        } else if (node->n_pins > 0) {
+            forward_pins(node);
+        }
+
+        unlink(node);
         node->add_ref_count(-2);
 
-        if (first == last) {
-            first = last = END_NODE;
-        } else if (node == first) {
+        if (n_push_waiters > 0) {
+            not_full.notify_one();
+        }
+        trim_if_low();
+    }
+
+    // Once per drop to the low water mark. Caller holds m. The trim itself
+    // waits for unlock_and_trim(): with heap_allocation it is a process-wide
+    // malloc_trim(), with huge_page_arena it unmaps chunks of a pool other
+    // lists share, and neither should stall this list.
+    void trim_if_low() {
+        if (trim_armed && list_size <= low_water_mark) {
+            trim_armed = false;
+            trim_due = true;
+        }
+    }
+
+    // m.unlock() for the calls that remove nodes.
+    void unlock_and_trim() {
+        bool due = std::exchange(trim_due, false);
+        m.unlock();
+        if (due) {
+            trim();
+        }
+    }
+
+    class already_locked {
+    };
+
+    // Shared lock for operations that only read the list, when the policy has one.
+    void read_lock() {
+        if constexpr (requires { m.lock_shared(); }) {
+            m.lock_shared();
+        } else {
+            m.lock();
+        }
+    }
+
+    void read_unlock() {
+        if constexpr (requires { m.unlock_shared(); }) {
+            m.unlock_shared();
+        } else {
+            m.unlock();
+        }
+    }
+
+    // Gives up at deadline. Policies without try_lock_until are polled with backoff.
+    bool lock_until(const std::chrono::steady_clock::time_point &deadline) {
+        if constexpr (requires { m.try_lock_until(deadline); }) {
+            return m.try_lock_until(deadline);
+        } else {
+            backoff b;
+            while (!m.try_lock()) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    return false;
+                }
+                b.pause();
+            }
+            return true;
+        }
+    }
+
+    // Runs op with m held. Without a deadline m is only taken if it is free.
+    template<typename Op>
+    list_status locked_try(const std::chrono::steady_clock::time_point *deadline, Op op) {
+        if (deadline == nullptr ? !m.try_lock() : !lock_until(*deadline)) {
+            return deadline == nullptr ? list_status::busy : list_status::timeout;
+        }
+        list_status res = op();
+        unlock_and_trim();
+        return res;
+    }
+
+    // The iterator res already holds locks its list when it is dropped, so
+    // the new one is only stored once m is released.
+    list_status locked_try_find(const std::chrono::steady_clock::time_point *deadline, const T &value,
+                                std::optional<consistent_iterator> &res) {
+        std::optional<consistent_iterator> found;
+        list_status status = locked_try(deadline, [&] {
+            found.emplace(consistent_iterator(find_node(value), already_locked()));
+            return list_status::ok;
+        });
+        if (found) {
+            res = std::move(*found);
+        }
+        return status;
+    }
+
+    // First live node holding value, END_NODE if there is none. Caller holds m.
+    Node *find_node(const T &value) {
+        return find_node_from(first, value);
+    }
+
+    // Same, from the live node front on. The list is walked from both ends
+    // at once: the next and prev chains do not depend on each other, so
+    // their cache misses overlap instead of coming one after another.
+    Node *find_node_from(Node *front, const T &value) {
+        if (front == END_NODE) {
+            return END_NODE;
+        }
+        Node *back = last;
+        // Nearest match to the front seen from the back so far.
+        Node *found = END_NODE;
+        while (true) {
+            if (front->value == value) {
+                return front;
+            }
+            if (front == back) {
+                return found;
+            }
+            if (back->value == value) {
+                found = back;
+            }
+            back = back->prev;
+            if (back == front) {
+                return found;
+            }
+            front = front->next;
+        }
+    }
+
+    T take_first() {
+        T res = first->value;
+        remove_node(first);
+        return res;
+    }
+
+    list_status take(T &res, bool front) {
+        if (list_size == 0) {
+            return list_status::empty;
+        }
+        Node *node = front ? first : last;
+        res = node->value;
+        remove_node(node);
+        return list_status::ok;
+    }
+
+    // Frees a tombstone the last iterator has left. Other tombstones that
+    // still lead to it are forwarded past it first. A neighbour that is a
+    // tombstone without iterators itself can go in turn.
+    void release_tombstone(Node *tombstone) {
+        std::vector<Node *> to_free = {tombstone};
+        while (!to_free.empty()) {
+            Node *node = to_free.back();
+            to_free.pop_back();
+            forward_pins(node);
+            n_tombstones--;
+            for (Node *neighbour : {node->prev, node->next}) {
+                unpin(neighbour, node);
+                if (neighbour != END_NODE &&
+                    RefCountPolicy::add(neighbour->ref_count, -1) <= neighbour->n_pins &&
+                    neighbour->is_tombstone) {
+                    to_free.push_back(neighbour);
+                }
+            }
+            n_deleted_node++;
+            delete node;
+        }
+        if (n_push_waiters > 0) {
+            not_full.notify_one();
+        }
+    }
+
+    size_t node_cost() const {
+        return unit == capacity_unit::bytes ? sizeof(Node) : 1;
+    }
+
+    bool has_room() const {
+        return capacity == 0 || (list_size + n_tombstones + 1) * node_cost() <= capacity;
+    }
+
+    void wait_for_room() {
+        if (has_room()) {
+            return;
+        }
+        n_push_waiters++;
+        while (!has_room()) {
+            not_full.wait(m);
+        }
+        n_push_waiters--;
+    }
+
+    bool wait_for_room_until(const std::chrono::steady_clock::time_point &deadline) {
+        if (has_room()) {
+            return true;
+        }
+        n_push_waiters++;
+        bool room = true;
+        while (!has_room()) {
+            if (not_full.wait_until(m, deadline) == std::cv_status::timeout && !has_room()) {
+                room = false;
+                break;
+            }
+        }
+        n_push_waiters--;
+        return room;
+    }
+
+    // prev and next are live neighbours or END_NODE, the list is circular through it.
+    void place_between(Node *prev, Node *next, Node *node) {
+        node->prev = prev;
+        prev->next = node;
+
+        node->next = next;
+        next->prev = node;
+
+        if (prev == END_NODE) {
+            first = node;
+        }
+        if (next == END_NODE) {
+            last = node;
+        }
+
+        list_size++;
+        if (low_water_mark != 0 && list_size > low_water_mark) {
+            trim_armed = true;
+        }
+    }
+
+    void link_between(Node *prev, Node *next, Node *new_node) {
+        place_between(prev, next, new_node);
+        new_node->add_ref_count(2);
+    }
+
+    // Cuts out a run of already freed nodes that lay between prev and next.
+    void close_run(Node *prev, Node *next, size_t run) {
+        prev->next = next;
+        next->prev = prev;
+        if (prev == END_NODE) {
             first = next;
-        } else if (node == last) {
+        }
+        if (next == END_NODE) {
             last = prev;
         }
+        list_size -= run;
+    }
 
+    // Erases the live nodes in [from, to) that match pred in one pass.
+    // Nodes nobody else references are freed on the spot and every run of
+    // them is unlinked with one relink; the others go through remove_node
+    // and may stay as tombstones. Caller holds m.
+    template<typename Pred>
+    size_t erase_matching(Node *from, Node *to, Pred &pred) {
+        size_t n = 0;
+        size_t run = 0;
+        Node *run_prev = nullptr;
+        Node *node = from;
+        try {
+            while (node != to && node != END_NODE) {
+                Node *next = node->next;
+                bool cut = pred(node->value);
+                if (cut && RefCountPolicy::load(node->ref_count) == 2) {
+                    if (run == 0) {
+                        run_prev = node->prev;
+                    }
+                    delete node;
+                    n_deleted_node++;
+                    run++;
+                } else {
+                    if (run > 0) {
+                        close_run(run_prev, node, run);
+                        run = 0;
+                    }
+                    if (cut) {
+                        remove_node(node);
+                    }
+                }
+                n += cut;
+                node = next;
+            }
+        } catch (...) {
+            if (run > 0) {
+                close_run(run_prev, node, run);
+            }
+            throw;
+        }
+        if (run > 0) {
+            close_run(run_prev, node, run);
+        }
+        if (n > 0 && n_push_waiters > 0) {
+            not_full.notify_all();
+        }
+        trim_if_low();
+        return n;
+    }
 
-        list_size--;
+    // Scans on from the node from points at, or from the one after it. A
+    // tombstone resumes at its nearest live successor. search gets the live
+    // node to start at and returns the match or END_NODE.
+    template<typename Search>
+    consistent_iterator resume_find(const consistent_iterator &from, Search &search, bool after) {
+        m.lock();
+        Node *node = from.get_node();
+        if (node->list() != this) {
+            m.unlock();
+            throw consistent_linked_list_exception("Iterator of another list.");
+        }
+        if (node->is_deleted) {
+            node = live_next(node);
+        } else if (after && node != END_NODE) {
+            node = node->next;
+        }
+        try {
+            node = search(node);
+        } catch (...) {
+            m.unlock();
+            throw;
+        }
+        consistent_iterator res(node, already_locked());
+        m.unlock();
+        return res;
+    }
+
+    // Lists are always locked in address order, so two threads moving
+    // nodes in opposite directions cannot deadlock.
+    void lock_pair(consistent_linked_list &other) {
+        if (&other == this) {
+            m.lock();
+        } else if (std::less<consistent_linked_list *>()(this, &other)) {
+            m.lock();
+            other.m.lock();
+        } else {
+            other.m.lock();
+            m.lock();
+        }
+    }
+
+    void unlock_pair(consistent_linked_list &other) {
+        m.unlock();
+        if (&other != this) {
+            other.m.unlock();
+        }
+    }
+
+    // Takes a live node out of source for this list without copying it.
+    // Iterators on it follow it. A node a tombstone of source still leads
+    // to has to stay in source: its value is copied and the node goes to
+    // left_behind, to be erased from source once the whole batch has moved.
+    // Erasing it right away would pin its neighbours, which are likely the
+    // next nodes to move. Caller holds both locks.
+    Node *adopt(consistent_linked_list &source, Node *node, std::vector<Node *> &left_behind) {
+        if (&source == this || node->n_pins == 0) {
+            source.unlink(node);
+            node->base_list.store(this, std::memory_order_relaxed);
+            return node;
+        }
+        Node *copy = create_new_node(node->value);
+        copy->add_ref_count(2);
+        left_behind.push_back(node);
+        return copy;
+    }
+
+    // Caller holds both locks.
+    void move_range(consistent_linked_list &source, Node *from, Node *to, Node *pos) {
+        std::vector<Node *> left_behind;
+        while (from != to && from != source.END_NODE) {
+            Node *following = from->next;
+            place_between(pos->prev, pos, adopt(source, from, left_behind));
+            from = following;
+        }
+        for (Node *node : left_behind) {
+            source.remove_node(node);
+        }
+    }
+
+    // Wakes whoever may proceed after nodes moved from source to this list,
+    // and runs the trim source became due for. Both locks are released.
+    void notify_moved(bool has_waiters, bool source_has_push_waiters, bool source_trim_due,
+                      consistent_linked_list &source) {
+        if (has_waiters) {
+            not_empty.notify_all();
+        }
+        if (source_has_push_waiters) {
+            source.not_full.notify_all();
+        }
+        if (source_trim_due) {
+            source.trim();
+        }
+    }
+
+    class split_tag {
+    };
+
+    consistent_linked_list(consistent_linked_list &source, const consistent_iterator &from, split_tag) :
+            consistent_linked_list() {
+        splice(end(), source, from, source.end());
+    }
+
+    void link_front(Node *new_node) {
+        link_between(END_NODE, first, new_node);
+    }
+
+    void link_back(Node *new_node) {
+        link_between(last, END_NODE, new_node);
+    }
+
+    // Nearest live node or END_NODE; walks off tombstones.
+    Node *live_prev(Node *node) {
+        Node *prev = node->prev;
+        while (prev->is_deleted && prev != END_NODE) {
+            prev = prev->prev;
+        }
+        return prev;
+    }
+
+    Node *live_next(Node *node) {
+        Node *next = node->next;
+        while (next->is_deleted && next != END_NODE) {
+            next = next->next;
+        }
+        return next;
+    }
+
+    // Links new_node next to the node t points at. If that node is a
+    // tombstone, next to the nearest live node on the requested side.
+    consistent_iterator insert_at(const consistent_iterator &t, Node *new_node, bool before) {
+        m.lock();
+        Node *node = t.get_node();
+        if (node->list() == this) {
+            // Waiting unlocks m, and a splice can carry the node away.
+            wait_for_room();
+        }
+        if (node->list() != this) {
+            m.unlock();
+            delete new_node;
+            throw consistent_linked_list_exception("Iterator of another list.");
+        }
+        if (before) {
+            Node *next = node->is_deleted ? live_next(node) : node;
+            link_between(next->prev, next, new_node);
+        } else {
+            Node *prev = node->is_deleted ? live_prev(node) : node;
+            link_between(prev, prev->next, new_node);
+        }
+        consistent_iterator res(new_node, already_locked());
+        bool has_waiters = n_waiters > 0;
+        m.unlock();
+
+        if (has_waiters) {
+            not_empty.notify_one();
+        }
+        return res;
+    }
+
+    // Called with m held. Returns true if a consumer has to be woken up.
+    bool link(Node *new_node, bool front) {
+        if (front) {
+            link_front(new_node);
+        } else {
+            link_back(new_node);
+        }
+        return n_waiters > 0;
+    }
+
+    list_status push(const T &value, bool front, const std::chrono::steady_clock::time_point *deadline) {
+        Node *new_node = create_new_node(value);
+
+        if (deadline == nullptr) {
+            m.lock();
+            wait_for_room();
+        } else if (!lock_until(*deadline)) {
+            delete new_node;
+            return list_status::timeout;
+        } else if (!wait_for_room_until(*deadline)) {
+            m.unlock();
+            delete new_node;
+            return list_status::timeout;
+        }
+        bool has_waiters = link(new_node, front);
+        m.unlock();
+
+        if (has_waiters) {
+            not_empty.notify_one();
+        }
+        return list_status::ok;
+    }
+
+    template<typename Update>
+    void push_updated(const T &value, bool front, Update &update) {
+        Node *new_node = create_new_node(value);
+        m.lock();
+        wait_for_room();
+        try {
+            update(new_node->value);
+        } catch (...) {
+            m.unlock();
+            delete new_node;
+            throw;
+        }
+        bool has_waiters = link(new_node, front);
+        m.unlock();
+
+        if (has_waiters) {
+            not_empty.notify_one();
+        }
+    }
+
+    list_status try_push(const T &value, bool front) {
+        Node *new_node = create_new_node(value);
+
+        if (!m.try_lock()) {
+            delete new_node;
+            return list_status::busy;
+        }
+        if (!has_room()) {
+            m.unlock();
+            delete new_node;
+            return list_status::full;
+        }
+        bool has_waiters = link(new_node, front);
+        m.unlock();
+
+        if (has_waiters) {
+            not_empty.notify_one();
+        }
+        return list_status::ok;
     }
 
 public:
     size_t n_deleted_node = 0;
 
-    class consistent_iterator;
-
     consistent_linked_list() {
-        END_NODE = new Node(this, 0);
+        END_NODE = new Node(this, T());
         END_NODE->next = END_NODE;
         END_NODE->prev = END_NODE;
         first = last = END_NODE;
@@ -106,113 +775,350 @@ public:
     }
 
     ~consistent_linked_list() {
-        for (auto it = begin(); it != end(); it++) {
-            erase(it);
+        m.lock();
+        while (first != END_NODE) {
+            remove_node(first);
         }
+        m.unlock();
         delete END_NODE;
     }
 
     void push_front(const T &value) {
-        Node *new_node = create_new_node(value);
+        push(value, true, nullptr);
+    }
 
-        m.lock();
-        new_node->prev = END_NODE;
-        END_NODE->next = new_node;
+    void push_back(const T &value) {
+        push(value, false, nullptr);
+    }
 
-        new_node->next = first;
-        first->prev = new_node;
+    // update(element) runs under the lock right before the element is
+    // linked, e.g. to stamp elements in the order they really enter the list.
+    template<typename Update>
+    void push_back_updated(const T &value, Update update) {
+        push_updated(value, false, update);
+    }
 
-        new_node->add_ref_count(2);
+    // O(1). Before end() is push_back, after end() is push_front.
+    consistent_iterator insert_before(const consistent_iterator &t, const T &value) {
+        return insert_at(t, create_new_node(value), true);
+    }
+
+    consistent_iterator insert_after(const consistent_iterator &t, const T &value) {
+        return insert_at(t, create_new_node(value), false);
+    }
+
+    // Constructs the value in place before t.
+    template<typename... Args>
+    consistent_iterator emplace_at(const consistent_iterator &t, Args &&...args) {
+        return insert_at(t, new Node(this, std::in_place, std::forward<Args>(args)...), true);
+    }
 
-        first = new_node;
-        if (last == END_NODE) {
-            last = first;
+    // Moves [from, to) of other in front of pos without copying, O(range).
+    // Tombstones in the range are skipped. The range must not contain pos.
+    // Like a push it ignores the capacity of this list.
+    void splice(const consistent_iterator &pos, consistent_linked_list &other,
+                const consistent_iterator &from, const consistent_iterator &to) {
+        lock_pair(other);
+        Node *pos_node = pos.get_node();
+        Node *from_node = from.get_node();
+        Node *to_node = to.get_node();
+        if (pos_node->list() != this || from_node->list() != &other || to_node->list() != &other) {
+            unlock_pair(other);
+            throw consistent_linked_list_exception("Iterator of another list.");
         }
+        move_range(other,
+                   from_node->is_deleted ? other.live_next(from_node) : from_node,
+                   to_node->is_deleted ? other.live_next(to_node) : to_node,
+                   pos_node->is_deleted ? live_next(pos_node) : pos_node);
+        bool has_waiters = n_waiters > 0;
+        bool other_has_push_waiters = other.n_push_waiters > 0;
+        bool other_trim_due = std::exchange(other.trim_due, false);
+        unlock_pair(other);
+
+        notify_moved(has_waiters, other_has_push_waiters, other_trim_due, other);
+    }
 
-        list_size++;
-        m.unlock();
+    void splice(const consistent_iterator &pos, consistent_linked_list &other) {
+        splice(pos, other, other.begin(), other.end());
     }
 
-    void push_back(const T &value) {
-        Node *new_node = create_new_node(value);
+    // Everything from it on moves to the returned list.
+    consistent_linked_list split_at(const consistent_iterator &it) {
+        return consistent_linked_list(*this, it, split_tag());
+    }
 
-        m.lock();
-        new_node->prev = last;
-        last->next = new_node;
+    // Both lists sorted by comp; moves every node of other into its place
+    // here, elements of this list go first among equal ones. O(size + other.size).
+    template<typename Compare = std::less<>>
+    void merge(consistent_linked_list &other, Compare comp = Compare()) {
+        if (&other == this) {
+            return;
+        }
+        lock_pair(other);
+        std::vector<Node *> left_behind;
+        Node *pos = first;
+        Node *node = other.first;
+        // If comp throws, what has moved so far stays here and the rest
+        // stays in other; nodes copied over are erased from other either way.
+        auto finish = [&] {
+            for (Node *node_ : left_behind) {
+                other.remove_node(node_);
+            }
+            bool has_waiters = n_waiters > 0;
+            bool other_has_push_waiters = other.n_push_waiters > 0;
+            bool other_trim_due = std::exchange(other.trim_due, false);
+            unlock_pair(other);
+            notify_moved(has_waiters, other_has_push_waiters, other_trim_due, other);
+        };
+        try {
+            while (node != other.END_NODE) {
+                Node *following = node->next;
+                while (pos != END_NODE && !comp(node->value, pos->value)) {
+                    pos = pos->next;
+                }
+                place_between(pos->prev, pos, adopt(other, node, left_behind));
+                node = following;
+            }
+        } catch (...) {
+            finish();
+            throw;
+        }
+        finish();
+    }
 
-        new_node->next = END_NODE;
-        END_NODE->prev = new_node;
+    // Appends [first, last) under a single lock acquisition.
+    template<typename InputIt>
+    void append(InputIt first, InputIt last) {
+        std::vector<Node *> nodes;
+        for (; first != last; ++first) {
+            nodes.push_back(create_new_node(*first));
+        }
+        if (nodes.empty()) {
+            return;
+        }
 
-        new_node->add_ref_count(2);
+        m.lock();
+        for (Node *node : nodes) {
+            wait_for_room();
+            link_back(node);
+        }
+        bool has_waiters = n_waiters > 0;
+        m.unlock();
 
-        last = new_node;
-        if (first == END_NODE) {
-            first = last;
+        if (has_waiters) {
+            not_empty.notify_all();
         }
+    }
 
-        list_size++;
+    // Never blocks: busy if another thread holds the lock, full if there is no room.
+    list_status try_push_front(const T &value) {
+        return try_push(value, true);
+    }
+
+    list_status try_push_back(const T &value) {
+        return try_push(value, false);
+    }
+
+    template<typename Rep, typename Period>
+    list_status push_front_for(const T &value, const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return push(value, true, &deadline);
+    }
+
+    template<typename Rep, typename Period>
+    list_status push_back_for(const T &value, const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return push(value, false, &deadline);
+    }
+
+    // limit == 0 removes the bound. Pushes block while the list is full.
+    void set_capacity(size_t limit, capacity_unit unit_ = capacity_unit::elements) {
+        m.lock();
+        capacity = limit;
+        unit = unit_;
+        m.unlock();
+        not_full.notify_all();
+    }
+
+    size_t get_capacity() {
+        m.lock();
+        size_t res = capacity;
+        m.unlock();
+        return res;
+    }
+
+    // Elements or bytes held, including tombstones pinned by iterators.
+    size_t used_capacity() {
+        m.lock();
+        size_t res = (list_size + n_tombstones) * node_cost();
         m.unlock();
+        return res;
     }
 
     void pop_first() {
         m.lock();
         remove_node(first);
-        m.unlock();
+        unlock_and_trim();
     }
 
     void pop_last() {
         m.lock();
         remove_node(last);
-        m.unlock();
+        unlock_and_trim();
     }
 
-    T front() {
+    std::optional<T> pop_first_value() {
         m.lock();
         if (list_size == 0) {
             m.unlock();
-            throw consistent_linked_list_exception("List size is 0.");
+            return std::nullopt;
         }
-        T res = first->value;
-        m.unlock();
+        T res = take_first();
+        unlock_and_trim();
         return res;
     }
 
-    T back() {
+    std::optional<T> pop_last_value() {
         m.lock();
         if (list_size == 0) {
             m.unlock();
-            throw consistent_linked_list_exception("List size is 0.");
+            return std::nullopt;
         }
         T res = last->value;
-        m.unlock();
+        remove_node(last);
+        unlock_and_trim();
+        return res;
+    }
+
+    // Never blocks: empty result if the list is empty or another thread holds the lock.
+    std::optional<T> try_pop_first() {
+        if (!m.try_lock()) {
+            return std::nullopt;
+        }
+        if (list_size == 0) {
+            m.unlock();
+            return std::nullopt;
+        }
+        T res = take_first();
+        unlock_and_trim();
+        return res;
+    }
+
+    list_status try_pop_first(T &res) {
+        return locked_try(nullptr, [&] { return take(res, true); });
+    }
+
+    list_status try_pop_last(T &res) {
+        return locked_try(nullptr, [&] { return take(res, false); });
+    }
+
+    // Waits at most timeout for the lock, not for an element.
+    template<typename Rep, typename Period>
+    list_status try_pop_first_for(T &res, const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return locked_try(&deadline, [&] { return take(res, true); });
+    }
+
+    template<typename Rep, typename Period>
+    list_status try_pop_last_for(T &res, const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return locked_try(&deadline, [&] { return take(res, false); });
+    }
+
+    T wait_pop_first() {
+        m.lock();
+        n_waiters++;
+        while (list_size == 0) {
+            not_empty.wait(m);
+        }
+        n_waiters--;
+        T res = take_first();
+        unlock_and_trim();
+        return res;
+    }
+
+    template<typename Rep, typename Period>
+    std::optional<T> pop_for(const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        if (!lock_until(deadline)) {
+            return std::nullopt;
+        }
+        n_waiters++;
+        while (list_size == 0) {
+            if (not_empty.wait_until(m, deadline) == std::cv_status::timeout && list_size == 0) {
+                n_waiters--;
+                m.unlock();
+                return std::nullopt;
+            }
+        }
+        n_waiters--;
+        T res = take_first();
+        unlock_and_trim();
+        return res;
+    }
+
+    // Empty result instead of an exception when the list is empty.
+    std::optional<T> front_value() noexcept(std::is_nothrow_copy_constructible_v<T>) {
+        read_lock();
+        std::optional<T> res;
+        if (list_size != 0) {
+            res.emplace(first->value);
+        }
+        read_unlock();
+        return res;
+    }
+
+    std::optional<T> back_value() noexcept(std::is_nothrow_copy_constructible_v<T>) {
+        read_lock();
+        std::optional<T> res;
+        if (list_size != 0) {
+            res.emplace(last->value);
+        }
+        read_unlock();
         return res;
     }
 
+    T front() {
+        std::optional<T> res = front_value();
+        if (!res) {
+            throw consistent_linked_list_exception("List size is 0.");
+        }
+        return std::move(*res);
+    }
+
+    T back() {
+        std::optional<T> res = back_value();
+        if (!res) {
+            throw consistent_linked_list_exception("List size is 0.");
+        }
+        return std::move(*res);
+    }
+
     consistent_iterator begin() {
         m.lock();
-        auto res = consistent_iterator(first);
+        consistent_iterator res(first, already_locked());
         m.unlock();
         return res;
     }
 
     consistent_iterator end() {
         m.lock();
-        auto res = consistent_iterator(END_NODE);
+        consistent_iterator res(END_NODE, already_locked());
         m.unlock();
         return res;
     }
 
     bool empty() {
-        m.lock();
-        int res = list_size;
-        m.unlock();
+        read_lock();
+        size_t res = list_size;
+        read_unlock();
         return res == 0;
     }
 
     size_t size() {
-        m.lock();
-        int res = list_size;
-        m.unlock();
+        read_lock();
+        size_t res = list_size;
+        read_unlock();
         return res;
     }
 
@@ -223,271 +1129,532 @@ public:
             m.unlock();
             throw consistent_linked_list_exception("Deleted end iterator.");
         }
+        if (node->list() != this) {
+            m.unlock();
+            throw consistent_linked_list_exception("Iterator of another list.");
+        }
         remove_node(node);
-        m.unlock();
+        unlock_and_trim();
     }
 
     void erase(const T &value) {
         m.lock();
-        consistent_iterator it = begin();
-        for (; it != end(); it++) {
-            if (*it == value) {
-                break;
-            }
+        remove_node(find_node(value));
+        unlock_and_trim();
+    }
+
+    // Erases [from, to) under one lock, returns the number of elements erased.
+    size_t erase(const consistent_iterator &from, const consistent_iterator &to) {
+        m.lock();
+        Node *from_node = from.get_node();
+        Node *to_node = to.get_node();
+        if (from_node->list() != this || to_node->list() != this) {
+            m.unlock();
+            throw consistent_linked_list_exception("Iterator of another list.");
+        }
+        auto all = [](const T &) { return true; };
+        size_t res = erase_matching(from_node->is_deleted ? live_next(from_node) : from_node,
+                                    to_node->is_deleted ? live_next(to_node) : to_node, all);
+        unlock_and_trim();
+        return res;
+    }
+
+    // Erases the values of a container in one traversal, O(size + values.size()).
+    // T needs std::hash. Returns the number of elements erased.
+    template<typename Container>
+    size_t erase_all(const Container &values, erase_mode mode = erase_mode::all) {
+        std::unordered_set<T> targets(std::begin(values), std::end(values));
+        if (targets.empty()) {
+            return 0;
         }
-        if (it != end()) {
-            erase(it);
+        if (mode == erase_mode::all) {
+            return erase_if([&](const T &value) { return targets.count(value) != 0; });
         }
-        m.unlock();
+        return erase_if([&](const T &value) { return targets.erase(value) != 0; });
     }
 
-    consistent_iterator find(const T &value) {
+    // One traversal under one lock, returns the number of elements erased.
+    template<typename Pred>
+    size_t erase_if(Pred pred) {
         m.lock();
-        for (consistent_iterator it = begin(); it != end(); it++) {
-            if (*it == value) {
-                auto res = it;
-                m.unlock();
-                return res;
-            }
+        size_t res;
+        try {
+            res = erase_matching(first, END_NODE, pred);
+        } catch (...) {
+            unlock_and_trim();
+            throw;
+        }
+        unlock_and_trim();
+        return res;
+    }
+
+    // The compound calls below act on the node the iterator points at and do
+    // nothing if it is end(), has already been erased or is in another list.
+    std::optional<T> erase_and_get(const consistent_iterator &t) {
+        m.lock();
+        Node *node = t.get_node();
+        std::optional<T> res;
+        if (node->list() == this && !node->is_deleted && node != END_NODE) {
+            res.emplace(node->value);
+            remove_node(node);
+        }
+        unlock_and_trim();
+        return res;
+    }
+
+    // Returns the old value.
+    std::optional<T> replace(const consistent_iterator &t, const T &value) {
+        m.lock();
+        Node *node = t.get_node();
+        std::optional<T> res;
+        if (node->list() == this && !node->is_deleted && node != END_NODE) {
+            res.emplace(std::exchange(node->value, value));
         }
-        auto res = end();
         m.unlock();
         return res;
     }
 
-    bool contain(const T &value) {
+    bool compare_and_erase(const consistent_iterator &t, const T &expected) {
         m.lock();
-        consistent_iterator it = begin();
-        consistent_iterator end_it = end();
-        while (it != end_it) {
-            if (value == *it) {
-                m.unlock();
-                return true;
-            }
-            it++;
+        Node *node = t.get_node();
+        bool res = node->list() == this && !node->is_deleted && node != END_NODE && node->value == expected;
+        if (res) {
+            remove_node(node);
+        }
+        unlock_and_trim();
+        return res;
+    }
+
+    // push_back unless an equal value is already in the list.
+    bool insert_if_absent(const T &value) {
+        Node *new_node = create_new_node(value);
+
+        m.lock();
+        bool absent = find_node(value) == END_NODE;
+        if (absent && !has_room()) {
+            wait_for_room();
+            // The lock was released while waiting, somebody may have inserted it.
+            absent = find_node(value) == END_NODE;
+        }
+        if (!absent) {
+            m.unlock();
+            delete new_node;
+            return false;
         }
+        bool has_waiters = link(new_node, false);
         m.unlock();
-        return false;
+
+        if (has_waiters) {
+            not_empty.notify_one();
+        }
+        return true;
     }
 
-    void shrink_to_fit() {
+    consistent_iterator find(const T &value) {
         m.lock();
-        consistent_linked_list list;
-        consistent_iterator it = begin();
-        consistent_iterator end_it = end();
-        while (it != end_it) {
-            list.push_back(*it);
+        consistent_iterator res(find_node(value), already_locked());
+        m.unlock();
+        return res;
+    }
+
+    // Like find(), but starts at from instead of begin(), from included.
+    consistent_iterator find_from(const consistent_iterator &from, const T &value) {
+        auto search = [&](Node *node) { return find_node_from(node, value); };
+        return resume_find(from, search, false);
+    }
+
+    // pred is called in list order, up to the first match.
+    template<typename Pred>
+    consistent_iterator find_if_from(const consistent_iterator &from, Pred pred) {
+        auto search = [&](Node *node) {
+            while (node != END_NODE && !pred(node->value)) {
+                node = node->next;
+            }
+            return node;
+        };
+        return resume_find(from, search, false);
+    }
+
+    // Successive occurrences of a value. Each step resumes after the
+    // previous match, which stays pinned in between.
+    class match_range {
+    private:
+        consistent_linked_list &list;
+        T value;
+
+    public:
+        class iterator {
+        private:
+            match_range *range;
+            consistent_iterator it;
+
+        public:
+            iterator(match_range *range_, consistent_iterator it_) : range(range_), it(std::move(it_)) {}
+
+            T operator*() {
+                return *it;
+            }
+
+            iterator &operator++() {
+                consistent_linked_list &list = range->list;
+                auto search = [&](Node *node) { return list.find_node_from(node, range->value); };
+                it = list.resume_find(it, search, true);
+                return *this;
+            }
+
+            bool operator!=(const iterator &rhs) const {
+                return it != rhs.it;
+            }
+
+            bool operator==(const iterator &rhs) const {
+                return it == rhs.it;
+            }
+
+            const consistent_iterator &position() const {
+                return it;
+            }
+        };
+
+        match_range(consistent_linked_list &list_, const T &value_) : list(list_), value(value_) {}
+
+        iterator begin() {
+            return iterator(this, list.find(value));
         }
 
-        while (first != END_NODE) {
-            Node *next = first->next;
-            delete first;
-            first = next;
+        iterator end() {
+            return iterator(this, list.end());
         }
+    };
+
+    match_range matches(const T &value) {
+        return match_range(*this, value);
+    }
+
+    // The value is erased if the lock could be taken, absent values are ignored like in erase().
+    list_status try_erase(const T &value) {
+        return locked_try(nullptr, [&] {
+            remove_node(find_node(value));
+            return list_status::ok;
+        });
+    }
+
+    template<typename Rep, typename Period>
+    list_status try_erase_for(const T &value, const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return locked_try(&deadline, [&] {
+            remove_node(find_node(value));
+            return list_status::ok;
+        });
+    }
+
+    // On ok res holds the same iterator find() would return.
+    list_status try_find(const T &value, std::optional<consistent_iterator> &res) {
+        return locked_try_find(nullptr, value, res);
+    }
 
+    template<typename Rep, typename Period>
+    list_status try_find_for(const T &value, std::optional<consistent_iterator> &res,
+                             const std::chrono::duration<Rep, Period> &timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return locked_try_find(&deadline, value, res);
+    }
+
+    bool contain(const T &value) {
+        read_lock();
+        bool res = find_node(value) != END_NODE;
+        read_unlock();
+        return res;
+    }
+
+    // E.g. to ask a contention_adaptive_lock which mode it is in. Locking it
+    // by hand blocks every other call on the list.
+    LockPolicy &get_lock_policy() {
+        return m;
+    }
+
+    // Nodes are allocated one by one, there is nothing to compact. Tombstones
+    // go away on their own when the last iterator pointing at them does.
+    void shrink_to_fit() {}
+
+    // Gives node memory that no node uses any more back to the OS: empty
+    // huge_page_arena chunks are unmapped, with heap_allocation it is left to
+    // malloc_trim(). Live nodes and tombstones stay where they are. The pool
+    // is shared by all lists of the same type, so this trims for them too.
+    // Returns the bytes released, 0 if the policy cannot tell.
+    size_t trim() {
+        return AllocationPolicy::template release_unused<sizeof(Node), alignof(Node)>();
+    }
+
+    // After a spike: once the size has been above n, dropping back to n or
+    // below calls trim() by itself, right after the call that shrank the
+    // list has released the lock. 0 turns it off.
+    void set_low_water_mark(size_t n) {
+        m.lock();
+        low_water_mark = n;
+        trim_armed = n != 0 && list_size > n;
         m.unlock();
-        *this = list;
+    }
+
+    // Live nodes, of this and every other list of the same type, that sit on
+    // huge pages. Always 0 unless AllocationPolicy is huge_page_arena.
+    size_t nodes_on_huge_pages() {
+        return AllocationPolicy::template nodes_on_huge_pages<sizeof(Node), alignof(Node)>();
     }
 
     void print() {
-        m.lock();
-        std::string offset_space(' ', 3);
+        read_lock();
+        std::string offset_space(3, ' ');
         std::cout << "{ size = " << list_size << std::endl;
-        consistent_iterator it = begin();
-        for (size_t i = 0; i < list_size; i++) {
+        for (Node *node = first; node != END_NODE; node = node->next) {
             std::cout << offset_space <<
-                 "[value = " << *it <<
-                 ", ref_count = " << it->get_node()->ref_count <<
+                 "[value = " << node->value <<
+                 ", ref_count = " << RefCountPolicy::load(node->ref_count) <<
                  "]";
-            it++;
-            if (i != list_size - 1) {
+            if (node != last) {
                 std::cout << ", ";
             }
             std::cout << '\n';
         }
         std::cout << "}\n";
-        m.unlock();
+        read_unlock();
     }
 
+    // Copies from both ends at once, like find_node_from.
     std::vector<T> to_vector() {
-        m.lock();
-        std::vector<T> v(list_size);
-        int i = 0;
-        for (auto it = begin(); it != end(); it++) {
-            v[i++] = *it;
+        read_lock();
+        std::vector<T> v;
+        std::vector<T> back_half;
+        v.reserve(list_size);
+        back_half.reserve(list_size / 2);
+        Node *front = first;
+        Node *back = last;
+        for (size_t i = 0; i < list_size / 2; ++i) {
+            v.push_back(front->value);
+            back_half.push_back(back->value);
+            front = front->next;
+            back = back->prev;
         }
-        m.unlock();
+        if (list_size % 2 != 0) {
+            v.push_back(front->value);
+        }
+        read_unlock();
+        v.insert(v.end(), back_half.rbegin(), back_half.rend());
         return v;
     }
 
     class consistent_iterator {
     private:
-        std::recursive_mutex &m;
+        friend class consistent_linked_list;
+
         Node *node = nullptr;
 
-        Node *get_not_deleted_prev(Node *node_) {
-            Node *prev = node_->prev;
-            Node *end_node = node_->base_list->END_NODE;
-            while (prev->is_deleted && prev != end_node) {
-                prev = prev->prev;
+        // Caller holds the lock of node's list.
+        consistent_iterator(Node *node_, already_locked) {
+            node = node_;
+            node->add_ref_count(1);
+        }
+
+        // The node can be spliced into another list until its list is
+        // locked, so the list is looked up again once the lock is held.
+        consistent_linked_list *lock_list() const {
+            while (true) {
+                consistent_linked_list *list = node->list();
+                list->m.lock();
+                if (node->list() == list) {
+                    return list;
+                }
+                list->m.unlock();
+            }
+        }
+
+        // nullptr if the list is locked.
+        consistent_linked_list *try_lock_list() const {
+            consistent_linked_list *list = node->list();
+            if (!list->m.try_lock()) {
+                return nullptr;
+            }
+            if (node->list() != list) {
+                list->m.unlock();
+                return nullptr;
+            }
+            return list;
+        }
+
+        // Caller holds m.
+        void move_to(Node *node_) {
+            node->add_ref_count(-1);
+            node = node_;
+            node->add_ref_count(1);
+        }
+
+        void advance() {
+            if (!move_next()) {
+                throw consistent_linked_list_exception("No more element.");
             }
-            return prev;
         }
 
-        Node *get_not_deleted_next(Node *node_) {
-            Node *next = node_->next;
-            Node *end_node = node_->base_list->END_NODE;
-            while (next->is_deleted && next != end_node) {
-                next = next->next;
+        void retreat() {
+            if (!move_prev()) {
+                throw consistent_linked_list_exception("It's first element.");
             }
-            return next;
         }
 
     public:
-        consistent_iterator(Node *node_) : m(node_->base_list->m) {
+        consistent_iterator(Node *node_) {
             node = node_;
+            consistent_linked_list *list = lock_list();
             node->add_ref_count(1);
+            list->m.unlock();
         }
 
         consistent_iterator(const consistent_iterator &original) :
                 consistent_iterator(original.node) {}
 
+        // Takes over the reference of original, no lock needed.
+        consistent_iterator(consistent_iterator &&original) noexcept {
+            node = original.node;
+            original.node = nullptr;
+        }
+
+        consistent_iterator &operator=(consistent_iterator other) noexcept {
+            std::swap(node, other.node);
+            return *this;
+        }
+
         ~consistent_iterator() {
+            if (node == nullptr) {
+                return;
+            }
+            consistent_linked_list *list = lock_list();
             node->add_ref_count(-1);
+            list->m.unlock();
         }
 
+        // Copied under the lock: replace() changes the value of a linked node.
         T operator*() {
-            return node->value;
+            consistent_linked_list *list = lock_list();
+            try {
+                T res = node->value;
+                list->m.unlock();
+                return res;
+            } catch (...) {
+                list->m.unlock();
+                throw;
+            }
         }
 
-        Node *get_node() {
-            return node;
+        // END_NODE never changes, so this needs no lock.
+        bool is_end() const noexcept {
+            return node == node->list()->END_NODE;
         }
 
-        // prefix++
-        consistent_iterator operator++() {
-            m.lock();
-            if (node == node->base_list->END_NODE) {
-                m.unlock();
-                throw consistent_linked_list_exception("No more element.");
+        // Like ++/-- but return false at the boundary instead of throwing.
+        bool move_next() noexcept {
+            consistent_linked_list *list = lock_list();
+            if (node == list->END_NODE) {
+                list->m.unlock();
+                return false;
             }
+            move_to(list->live_next(node));
+            list->m.unlock();
+            return true;
+        }
 
-            Node *next = get_not_deleted_next(node);
-
-            node->add_ref_count(-1);
-            node = next;
-            node->add_ref_count(1);
+        bool move_prev() noexcept {
+            consistent_linked_list *list = lock_list();
+            Node *prev = list->live_prev(node);
+            if (prev == list->END_NODE) {
+                list->m.unlock();
+                return false;
+            }
+            move_to(prev);
+            list->m.unlock();
+            return true;
+        }
 
-            auto res = consistent_iterator(node);
-            m.unlock();
-            return res;
+        Node *get_node() const {
+            return node;
         }
 
-        // postfix++
-        consistent_iterator operator++(int) {
-            m.lock();
-            if (node == node->base_list->END_NODE) {
-                m.unlock();
-                throw consistent_linked_list_exception("No more element.");
+        // Never block: busy if the list is locked, end if there is nowhere to go.
+        list_status try_advance() {
+            consistent_linked_list *list = try_lock_list();
+            if (list == nullptr) {
+                return list_status::busy;
+            }
+            if (node == list->END_NODE) {
+                list->m.unlock();
+                return list_status::end;
             }
+            move_to(list->live_next(node));
+            list->m.unlock();
+            return list_status::ok;
+        }
 
-            Node *next = get_not_deleted_next(node);
-            consistent_iterator temp = consistent_iterator(node);
+        list_status try_retreat() {
+            consistent_linked_list *list = try_lock_list();
+            if (list == nullptr) {
+                return list_status::busy;
+            }
+            Node *prev = list->live_prev(node);
+            if (prev == list->END_NODE) {
+                list->m.unlock();
+                return list_status::end;
+            }
+            move_to(prev);
+            list->m.unlock();
+            return list_status::ok;
+        }
 
-            node->add_ref_count(-1);
-            node = next;
-            node->add_ref_count(1);
+        // prefix++
+        consistent_iterator &operator++() {
+            advance();
+            return *this;
+        }
 
-            m.unlock();
+        // postfix++
+        consistent_iterator operator++(int) {
+            consistent_iterator temp(*this);
+            advance();
             return temp;
         }
 
         // prefix--
-        consistent_iterator operator--() {
-            m.lock();
-            Node *prev = get_not_deleted_prev(node);
-
-            if (prev == node->base_list->END_NODE) {
-                m.unlock();
-                throw consistent_linked_list_exception("It's first element.");
-            }
-
-            node->add_ref_count(-1);
-            node = prev;
-            prev->add_ref_count(1);
-
-            auto res = consistent_iterator(node);
-            m.unlock();
-            return res;
+        consistent_iterator &operator--() {
+            retreat();
+            return *this;
         }
 
         // postfix--
         consistent_iterator operator--(int) {
-            m.lock();
-            Node *prev = get_not_deleted_prev(node);
-
-            if (prev == node->base_list->END_NODE) {
-                m.unlock();
-                throw consistent_linked_list_exception("It's first element.");
-            }
-
-            consistent_iterator temp = consistent_iterator(node);
-
-            node->add_ref_count(-1);
-            node = prev;
-            node->add_ref_count(1);
-
-            m.unlock();
+            consistent_iterator temp(*this);
+            retreat();
             return temp;
         }
 
-        bool operator!=(consistent_iterator rhs) const {
-            m.lock();
-            bool b = &(*this->node) != &(*rhs.node);
-            m.unlock();
-            return b;
+        // Iterators only compare their own node pointers, no lock needed.
+        bool operator!=(const consistent_iterator &rhs) const {
+            return node != rhs.node;
         }
 
-        bool operator==(consistent_iterator rhs) const {
-            m.lock();
-            bool b = &(*this->node) == &(*rhs.node);
-            m.unlock();
-            return b;
+        bool operator==(const consistent_iterator &rhs) const {
+            return node == rhs.node;
         }
 
         void erase() {
-            m.lock();
-            if (node->is_deleted)
-                m.unlock();
-            return;
-
-            node->base_list->erase(*this);
-            m.unlock();
+            consistent_linked_list *list = lock_list();
+            list->remove_node(node);
+            list->unlock_and_trim();
         }
 
         static consistent_iterator next(consistent_iterator it) {
-            if (it.get_node() == it.get_node()->base_list->END_NODE) {
-                throw consistent_linked_list_exception("No more elements");
-            }
-
-            Node *next = it.get_not_deleted_next(it.get_node());
-
-            it.get_node()->add_ref_count(-1);
-            next->add_ref_count(1);
-            return consistent_iterator(next);
+            ++it;
+            return it;
         }
 
         static consistent_iterator prev(consistent_iterator it) {
-            Node *prev = it.get_not_deleted_prev(it.get_node());
-
-            if (prev == it.get_node()->base_list->END_NODE) {
-                throw consistent_linked_list_exception("It's first element.");
-            }
-
-
-            it.get_node()->add_ref_count(-1);
-            prev->add_ref_count(1);
-            return consistent_iterator(prev);
+            --it;
+            return it;
         }
     };
 
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "consistent_linked_list.h"
+
+template<typename T>
+class elimination_list {
+private:
+    enum slot_state {
+        EMPTY, BUSY, PUSH_WAITING, POP_WAITING, MATCHED
+    };
+
+    // Meeting point for one push_front and one pop_first. The thread that
+    // parked in the slot is the one that returns it to EMPTY.
+    class alignas(64) exchanger {
+    public:
+        std::atomic<int> state{EMPTY};
+        T value = T();
+    };
+
+    consistent_linked_list<T> list;
+
+    std::unique_ptr<exchanger[]> slots;
+    size_t n_slots;
+    int spin_count;
+
+    std::atomic<int> active{0};
+    std::atomic<size_t> n_eliminated{0};
+
+    // Recent elimination success. Grows on matches and decays on misses, so
+    // an array that keeps timing out is only probed now and then.
+    std::atomic<int> score{0};
+    std::atomic<size_t> n_attempts{0};
+
+    bool should_eliminate() {
+        if (active.load(std::memory_order_relaxed) <= 1) {
+            return false;
+        }
+        if (score.load(std::memory_order_relaxed) > 0) {
+            return true;
+        }
+        return n_attempts.fetch_add(1, std::memory_order_relaxed) % 64 == 0;
+    }
+
+    void record(bool matched) {
+        int s = score.load(std::memory_order_relaxed);
+        if (matched) {
+            score.store(std::min(s + 8, 256), std::memory_order_relaxed);
+        } else if (s > 0) {
+            score.store(s - 1, std::memory_order_relaxed);
+        }
+    }
+
+    exchanger &random_slot() {
+        static thread_local size_t seed = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return slots[seed % n_slots];
+    }
+
+    bool wait_matched(exchanger &e) {
+        for (int i = 0; i < spin_count; i++) {
+            if (e.state.load(std::memory_order_acquire) == MATCHED) {
+                return true;
+            }
+            cpu_relax();
+        }
+        return false;
+    }
+
+    bool try_eliminate_push(const T &value) {
+        exchanger &e = random_slot();
+        int state = e.state.load(std::memory_order_acquire);
+
+        if (state == POP_WAITING) {
+            if (!e.state.compare_exchange_strong(state, BUSY, std::memory_order_acquire)) {
+                return false;
+            }
+            e.value = value;
+            e.state.store(MATCHED, std::memory_order_release);
+            return true;
+        }
+
+        if (state != EMPTY || !e.state.compare_exchange_strong(state, BUSY, std::memory_order_acquire)) {
+            return false;
+        }
+        e.value = value;
+        e.state.store(PUSH_WAITING, std::memory_order_release);
+
+        if (!wait_matched(e)) {
+            int expected = PUSH_WAITING;
+            if (e.state.compare_exchange_strong(expected, EMPTY, std::memory_order_acq_rel)) {
+                return false;
+            }
+            // A pop took the value between the timeout and the CAS.
+            while (e.state.load(std::memory_order_acquire) != MATCHED) {
+                std::this_thread::yield();
+            }
+        }
+        e.state.store(EMPTY, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> try_eliminate_pop() {
+        exchanger &e = random_slot();
+        int state = e.state.load(std::memory_order_acquire);
+
+        if (state == PUSH_WAITING) {
+            if (!e.state.compare_exchange_strong(state, BUSY, std::memory_order_acquire)) {
+                return std::nullopt;
+            }
+            T res = e.value;
+            e.state.store(MATCHED, std::memory_order_release);
+            return res;
+        }
+
+        if (state != EMPTY || !e.state.compare_exchange_strong(state, POP_WAITING, std::memory_order_acq_rel)) {
+            return std::nullopt;
+        }
+
+        if (!wait_matched(e)) {
+            int expected = POP_WAITING;
+            if (e.state.compare_exchange_strong(expected, EMPTY, std::memory_order_acq_rel)) {
+                return std::nullopt;
+            }
+            while (e.state.load(std::memory_order_acquire) != MATCHED) {
+                std::this_thread::yield();
+            }
+        }
+        T res = e.value;
+        e.state.store(EMPTY, std::memory_order_release);
+        return res;
+    }
+
+public:
+    explicit elimination_list(size_t n_slots_ = 8, int spin_count_ = 128) :
+            n_slots(n_slots_ == 0 ? 1 : n_slots_), spin_count(spin_count_) {
+        slots.reset(new exchanger[n_slots]);
+    }
+
+    void push_front(const T &value) {
+        // Elimination only pays off when other threads are inside too.
+        active.fetch_add(1, std::memory_order_relaxed);
+        bool matched = false;
+        if (should_eliminate()) {
+            matched = try_eliminate_push(value);
+            record(matched);
+        }
+        if (matched) {
+            n_eliminated.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            list.push_front(value);
+        }
+        active.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::optional<T> pop_first() {
+        active.fetch_add(1, std::memory_order_relaxed);
+        std::optional<T> res;
+        if (should_eliminate()) {
+            res = try_eliminate_pop();
+            record(res.has_value());
+        }
+        if (res) {
+            n_eliminated.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            res = list.pop_first_value();
+        }
+        active.fetch_sub(1, std::memory_order_relaxed);
+        return res;
+    }
+
+    bool empty() {
+        return list.empty();
+    }
+
+    size_t size() {
+        return list.size();
+    }
+
+    std::vector<T> to_vector() {
+        return list.to_vector();
+    }
+
+    // Number of push_front/pop_first calls that never reached the list.
+    size_t eliminated() {
+        return n_eliminated.load(std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "iostream"
+#include "vector"
+#include <mutex>
+#include <thread>
+
+#include "elimination_list.h"
+
+namespace elimination_list_tests {
+    using namespace std;
+
+    const int N_TEST = 100;
+    int N_THREADS = 8;
+
+    string test_case = "NULL";
+
+    void REQUIRE(bool b) {
+        if (!b) {
+            throw runtime_error("Fail. Test: " + test_case);
+        }
+    }
+
+    void sequential() {
+        test_case = "sequential";
+
+        elimination_list<int> list;
+        REQUIRE(!list.pop_first());
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_front(i);
+        }
+        for (int i = N_TEST - 1; i >= 0; --i) {
+            auto v = list.pop_first();
+            REQUIRE(v && *v == i);
+        }
+        REQUIRE(list.empty());
+        REQUIRE(list.eliminated() == 0);
+    }
+
+    void push_and_pop() {
+        test_case = "push_and_pop";
+
+        elimination_list<int> list;
+        vector<int> popped;
+        mutex m;
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                if (i % 2 == 0) {
+                    for (int j = 0; j < N_TEST; ++j) {
+                        list.push_front(i * N_TEST + j);
+                    }
+                    return;
+                }
+                vector<int> local;
+                while (local.size() < N_TEST) {
+                    auto v = list.pop_first();
+                    if (v) {
+                        local.push_back(*v);
+                    }
+                }
+                lock_guard<mutex> lock(m);
+                popped.insert(popped.end(), local.begin(), local.end());
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(list.empty());
+        REQUIRE(popped.size() == (size_t) (N_THREADS / 2 * N_TEST));
+        sort(popped.begin(), popped.end());
+        vector<int> expected;
+        for (int i = 0; i < N_THREADS; i += 2) {
+            for (int j = 0; j < N_TEST; ++j) {
+                expected.push_back(i * N_TEST + j);
+            }
+        }
+        REQUIRE(popped == expected);
+    }
+
+    void start() {
+        sequential();
+        push_and_pop();
+
+        std::cout << "Elimination list tests passed. Nice!" << endl;
+    }
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "consistent_linked_list.h"
+
+// combiner is the only lock: the list itself is lock-free underneath it,
+// so a combiner pass applies its whole batch under one acquisition.
+template<typename T>
+class flat_combining_list {
+private:
+    enum slot_state {
+        FREE, OWNED, PENDING, DONE
+    };
+
+    enum operation {
+        PUSH_BACK, PUSH_FRONT, POP_FIRST, POP_LAST
+    };
+
+    // One publication record. A thread owns it for the duration of one
+    // operation; the combiner only touches records in the PENDING state.
+    class alignas(64) slot {
+    public:
+        std::atomic<int> state{FREE};
+        operation op = PUSH_BACK;
+        T value = T();
+        // Popped value, set by the combiner before DONE.
+        std::optional<T> result;
+    };
+
+    consistent_linked_list<T, null_lock> list;
+
+    std::mutex combiner;
+    std::unique_ptr<slot[]> slots;
+    size_t n_slots;
+
+    size_t combined_ops = 0;
+    size_t combine_passes = 0;
+
+    slot &acquire_slot() {
+        size_t i = std::hash<std::thread::id>()(std::this_thread::get_id()) % n_slots;
+        while (true) {
+            int expected = FREE;
+            if (slots[i].state.compare_exchange_weak(expected, OWNED, std::memory_order_acquire)) {
+                return slots[i];
+            }
+            i = (i + 1) % n_slots;
+            if (i == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Caller holds combiner.
+    std::optional<T> apply(operation op, const T &value) {
+        switch (op) {
+            case PUSH_BACK:
+                list.push_back(value);
+                break;
+            case PUSH_FRONT:
+                list.push_front(value);
+                break;
+            case POP_FIRST:
+                return list.pop_first_value();
+            case POP_LAST:
+                return list.pop_last_value();
+        }
+        return std::nullopt;
+    }
+
+    // Caller holds combiner.
+    void combine() {
+        combine_passes++;
+        for (size_t i = 0; i < n_slots; i++) {
+            if (slots[i].state.load(std::memory_order_acquire) != PENDING) {
+                continue;
+            }
+            slots[i].result = apply(slots[i].op, slots[i].value);
+            combined_ops++;
+            slots[i].state.store(DONE, std::memory_order_release);
+        }
+    }
+
+    std::optional<T> execute(operation op, const T &value) {
+        // Uncontended: nobody to combine with, apply the request directly.
+        if (combiner.try_lock()) {
+            std::optional<T> res = apply(op, value);
+            combiner.unlock();
+            return res;
+        }
+
+        slot &s = acquire_slot();
+        s.op = op;
+        s.value = value;
+        s.state.store(PENDING, std::memory_order_release);
+
+        while (s.state.load(std::memory_order_acquire) != DONE) {
+            if (combiner.try_lock()) {
+                combine();
+                combiner.unlock();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        std::optional<T> res = std::move(s.result);
+        s.result.reset();
+        s.state.store(FREE, std::memory_order_release);
+        return res;
+    }
+
+public:
+    explicit flat_combining_list(size_t n_slots_ = 64) : n_slots(n_slots_ == 0 ? 1 : n_slots_) {
+        slots.reset(new slot[n_slots]);
+    }
+
+    void push_back(const T &value) {
+        execute(PUSH_BACK, value);
+    }
+
+    void push_front(const T &value) {
+        execute(PUSH_FRONT, value);
+    }
+
+    void pop_first() {
+        execute(POP_FIRST, T());
+    }
+
+    void pop_last() {
+        execute(POP_LAST, T());
+    }
+
+    // Empty result if the list was empty.
+    std::optional<T> pop_first_value() {
+        return execute(POP_FIRST, T());
+    }
+
+    std::optional<T> pop_last_value() {
+        return execute(POP_LAST, T());
+    }
+
+    T front() {
+        std::lock_guard<std::mutex> lock(combiner);
+        return list.front();
+    }
+
+    T back() {
+        std::lock_guard<std::mutex> lock(combiner);
+        return list.back();
+    }
+
+    bool empty() {
+        std::lock_guard<std::mutex> lock(combiner);
+        return list.empty();
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(combiner);
+        return list.size();
+    }
+
+    std::vector<T> to_vector() {
+        std::lock_guard<std::mutex> lock(combiner);
+        return list.to_vector();
+    }
+
+    // Requests applied by combiner passes, for the threads that published them.
+    size_t combined_count() {
+        std::lock_guard<std::mutex> lock(combiner);
+        return combined_ops;
+    }
+
+    // Average number of requests applied per combiner pass.
+    double combining_rate() {
+        std::lock_guard<std::mutex> lock(combiner);
+        if (combine_passes == 0) {
+            return 0;
+        }
+        return (double) combined_ops / combine_passes;
+    }
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "iostream"
+#include "vector"
+#include <thread>
+
+#include "flat_combining_list.h"
+
+namespace flat_combining_list_tests {
+    using namespace std;
+
+    const int N_TEST = 100;
+    int N_THREADS = 16;
+
+    string test_case = "NULL";
+
+    void REQUIRE(bool b) {
+        if (!b) {
+            throw runtime_error("Fail. Test: " + test_case);
+        }
+    }
+
+    void push() {
+        test_case = "push";
+
+        flat_combining_list<int> list(8);
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    if (i % 2) {
+                        list.push_back(1);
+                    } else {
+                        list.push_front(0);
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        auto v = list.to_vector();
+        REQUIRE(v.size() == (size_t) (N_THREADS * N_TEST));
+        REQUIRE(is_sorted(v.begin(), v.end()));
+    }
+
+    void push_and_pop() {
+        test_case = "push_and_pop";
+
+        flat_combining_list<int> list;
+        for (int i = 0; i < N_THREADS * N_TEST; ++i) {
+            list.push_back(i);
+        }
+
+        vector<vector<int>> popped(N_THREADS);
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    auto v = i % 2 ? list.pop_first_value() : list.pop_last_value();
+                    if (v) {
+                        popped[i].push_back(*v);
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(list.empty());
+        REQUIRE(!list.pop_first_value());
+        vector<int> all;
+        for (auto &part : popped) {
+            all.insert(all.end(), part.begin(), part.end());
+        }
+        sort(all.begin(), all.end());
+        REQUIRE(all.size() == (size_t) (N_THREADS * N_TEST));
+        for (int i = 0; i < N_THREADS * N_TEST; ++i) {
+            REQUIRE(all[i] == i);
+        }
+    }
+
+    // Copies slowly, so whoever holds the combiner holds it long enough
+    // for the other threads to publish their requests.
+    class slow_value {
+    public:
+        int v = 0;
+
+        slow_value() = default;
+
+        explicit slow_value(int v_) : v(v_) {}
+
+        slow_value(const slow_value &other) : v(other.v) {
+            this_thread::sleep_for(chrono::microseconds(20));
+        }
+
+        slow_value &operator=(const slow_value &other) = default;
+    };
+
+    void combines() {
+        test_case = "combines";
+
+        flat_combining_list<slow_value> list(8);
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    list.push_back(slow_value(i));
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(list.size() == (size_t) (N_THREADS * N_TEST));
+        REQUIRE(list.combined_count() > 0);
+    }
+
+    void start() {
+        push();
+        push_and_pop();
+        combines();
+
+        std::cout << "Flat combining list tests passed. Nice!" << endl;
+    }
+}
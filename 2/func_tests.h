@@ -47,7 +47,7 @@ namespace func_tests {
             auto list_vector = list.to_vector();
             int index = 0;
 
-            REQUIRE(list_vector.size() == i + 1);
+            REQUIRE(list_vector.size() == (size_t) (i + 1));
 
             for (int j = N_TEST - i - 1; j < N_TEST; j++) {
                 if (v[j] != list_vector[index++]) {
@@ -183,12 +183,12 @@ namespace func_tests {
         REQUIRE(list.size() == 0);
         for (int i = 0; i < N_TEST; ++i) {
             list.push_back(0);
-            REQUIRE(list.size() == i + 1);
+            REQUIRE(list.size() == (size_t) (i + 1));
         }
 
         for (int i = 0; i < N_TEST; ++i) {
             list.pop_last();
-            REQUIRE(list.size() == N_TEST - i - 1);
+            REQUIRE(list.size() == (size_t) (N_TEST - i - 1));
         }
     }
 
@@ -207,7 +207,7 @@ namespace func_tests {
                 real_size--;
             }
 
-            REQUIRE(list.size() == real_size);
+            REQUIRE(list.size() == (size_t) real_size);
         }
     }
 
@@ -279,6 +279,622 @@ namespace func_tests {
         REQUIRE(v == list.to_vector());
     }
 
+    void pop_value() {
+        test_case = "pop_value";
+        consistent_linked_list<int> list;
+
+        list.pop_first();
+        list.pop_last();
+        REQUIRE(list.size() == 0);
+        REQUIRE(!list.pop_first_value());
+        REQUIRE(!list.try_pop_first());
+        REQUIRE(!list.pop_for(chrono::milliseconds(1)));
+
+        fill_range(list, 0, N_TEST - 1);
+        for (int i = 0; i < N_TEST; ++i) {
+            optional<int> v;
+            if (i % 3 == 0) {
+                v = list.pop_first_value();
+            } else if (i % 3 == 1) {
+                v = list.try_pop_first();
+            } else {
+                v = list.pop_for(chrono::milliseconds(1));
+            }
+            REQUIRE(v && *v == i);
+            REQUIRE(list.size() == (size_t) (N_TEST - i - 1));
+        }
+        REQUIRE(list.empty());
+    }
+
+    void capacity() {
+        test_case = "capacity";
+        consistent_linked_list<int> list;
+        const int CAPACITY = 3;
+        list.set_capacity(CAPACITY);
+
+        for (int i = 0; i < CAPACITY; ++i) {
+            REQUIRE(list.try_push_back(i) == list_status::ok);
+        }
+        REQUIRE(list.try_push_back(CAPACITY) == list_status::full);
+        REQUIRE(list.try_push_front(CAPACITY) == list_status::full);
+        REQUIRE(list.push_back_for(CAPACITY, chrono::milliseconds(1)) == list_status::timeout);
+        REQUIRE(list.size() == CAPACITY);
+        REQUIRE(list.used_capacity() == CAPACITY);
+
+        {
+            // The popped node stays pinned by the iterator and still takes a slot.
+            auto it = list.begin();
+            list.pop_first();
+            REQUIRE(list.used_capacity() == CAPACITY);
+            REQUIRE(list.try_push_back(CAPACITY) == list_status::full);
+        }
+        REQUIRE(list.used_capacity() == CAPACITY - 1);
+        REQUIRE(list.push_front_for(-1, chrono::milliseconds(1)) == list_status::ok);
+        REQUIRE(list.to_vector() == get_vec({-1, 1, 2}));
+
+        list.set_capacity(0);
+        for (int i = 0; i < N_TEST; ++i) {
+            REQUIRE(list.try_push_back(i) == list_status::ok);
+        }
+    }
+
+    void capacity_bytes() {
+        test_case = "capacity_bytes";
+        consistent_linked_list<int> list;
+        list.set_capacity(0, capacity_unit::bytes);
+        list.push_back(0);
+        size_t node_size = list.used_capacity();
+        list.set_capacity(2 * node_size, capacity_unit::bytes);
+        REQUIRE(list.used_capacity() == node_size);
+
+        REQUIRE(list.try_push_back(1) == list_status::ok);
+        REQUIRE(list.try_push_back(2) == list_status::full);
+        list.pop_last();
+        REQUIRE(list.try_push_back(2) == list_status::ok);
+        REQUIRE(list.used_capacity() == 2 * node_size);
+    }
+
+    template<typename List>
+    void check_policy() {
+        List list;
+        vector<int> v;
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+            list.push_front(-i);
+            v.push_back(i);
+            v.insert(v.begin(), -i);
+        }
+        REQUIRE(list.to_vector() == v);
+        REQUIRE(list.contain(N_TEST / 2));
+        REQUIRE(*list.find(N_TEST / 2) == N_TEST / 2);
+
+        {
+            auto it = list.begin();
+            list.pop_first();
+            it++;
+            REQUIRE(*it == v[1]);
+        }
+
+        for (int i = 0; i < N_TEST; ++i) {
+            list.erase(i);
+        }
+        list.pop_last();
+        REQUIRE(list.size() == N_TEST - 2);
+        REQUIRE(list.front() == -(N_TEST - 2));
+        REQUIRE(list.back() == -1);
+        REQUIRE(list.try_pop_first() == -(N_TEST - 2));
+    }
+
+    void policies() {
+        test_case = "policies";
+        check_policy<consistent_linked_list<int, null_lock>>();
+        check_policy<consistent_linked_list<int, mutex_lock, atomic_ref_count>>();
+        check_policy<consistent_linked_list<int, spin_lock>>();
+        check_policy<consistent_linked_list<int, shared_mutex_lock, atomic_ref_count>>();
+        check_policy<consistent_linked_list<int, contention_adaptive_lock>>();
+    }
+
+    void iterator_erase() {
+        test_case = "iterator_erase";
+        consistent_linked_list<int> list;
+        fill_range(list, 0, N_TEST - 1);
+
+        auto it = list.find(N_TEST / 2);
+        it.erase();
+        it.erase();
+        REQUIRE(!list.contain(N_TEST / 2));
+        REQUIRE(list.size() == N_TEST - 1);
+
+        auto next = consistent_linked_list<int>::consistent_iterator::next(it);
+        REQUIRE(*next == N_TEST / 2 + 1);
+        auto prev = consistent_linked_list<int>::consistent_iterator::prev(next);
+        REQUIRE(*prev == N_TEST / 2 - 1);
+        REQUIRE(*(++it) == N_TEST / 2 + 1);
+        REQUIRE(*(it--) == N_TEST / 2 + 1);
+        REQUIRE(*it == N_TEST / 2 - 1);
+    }
+
+    void tombstone_chain() {
+        test_case = "tombstone_chain";
+        consistent_linked_list<int> list;
+        fill_range(list, 0, N_TEST - 1);
+
+        {
+            auto it = list.find(0);
+            for (int i = 0; i < N_TEST - 1; ++i) {
+                list.pop_first();
+                list.push_back(N_TEST + i);
+            }
+            auto last_it = list.find(2 * N_TEST - 2);
+            list.pop_last();
+            // Only the two nodes the iterators are on are kept, not the
+            // nodes popped after them.
+            REQUIRE(list.used_capacity() == list.size() + 2);
+            REQUIRE(list.n_deleted_node == N_TEST - 2);
+            REQUIRE(*(++it) == N_TEST - 1);
+            REQUIRE(++last_it == list.end());
+        }
+
+        REQUIRE(list.used_capacity() == list.size());
+        REQUIRE(list.n_deleted_node == N_TEST);
+    }
+
+    void parked_iterator() {
+        test_case = "parked_iterator";
+        const int N_CYCLES = 100000;
+        consistent_linked_list<int> list;
+        list.set_capacity(8);
+        fill_range(list, 0, 3);
+
+        auto parked = list.begin();
+        list.pop_first();
+        for (int i = 0; i < N_CYCLES; ++i) {
+            REQUIRE(list.try_push_back(i) == list_status::ok);
+            list.pop_first();
+        }
+        REQUIRE(list.size() == 3);
+        REQUIRE(list.used_capacity() == 4);
+        REQUIRE(list.n_deleted_node == N_CYCLES);
+
+        // A plain push on the bounded list must not block either.
+        list.push_back(-1);
+        REQUIRE(*(++parked) == N_CYCLES - 3);
+        REQUIRE(list.used_capacity() == 4);
+    }
+
+    void try_ops() {
+        test_case = "try_ops";
+        consistent_linked_list<int> list;
+
+        int v = -1;
+        REQUIRE(list.try_pop_first(v) == list_status::empty);
+        REQUIRE(list.try_pop_last_for(v, chrono::milliseconds(1)) == list_status::empty);
+        REQUIRE(v == -1);
+
+        fill_range(list, 0, N_TEST - 1);
+        REQUIRE(list.try_pop_first(v) == list_status::ok && v == 0);
+        REQUIRE(list.try_pop_last(v) == list_status::ok && v == N_TEST - 1);
+        REQUIRE(list.try_pop_first_for(v, chrono::milliseconds(1)) == list_status::ok && v == 1);
+        REQUIRE(list.try_erase(2) == list_status::ok);
+        REQUIRE(list.try_erase_for(N_TEST, chrono::milliseconds(1)) == list_status::ok);
+        REQUIRE(list.size() == N_TEST - 4);
+
+        optional<consistent_linked_list<int>::consistent_iterator> it;
+        REQUIRE(list.try_find(3, it) == list_status::ok && *(*it) == 3);
+        REQUIRE(it->try_retreat() == list_status::end);
+        REQUIRE(it->try_advance() == list_status::ok && *(*it) == 4);
+        REQUIRE(list.try_find_for(N_TEST - 2, it, chrono::milliseconds(1)) == list_status::ok);
+        REQUIRE(it->try_advance() == list_status::ok && *it == list.end());
+        REQUIRE(it->try_advance() == list_status::end);
+    }
+
+    void noexcept_api() {
+        test_case = "noexcept_api";
+        consistent_linked_list<int> list;
+        static_assert(noexcept(list.front_value()));
+
+        REQUIRE(!list.front_value());
+        REQUIRE(!list.back_value());
+        REQUIRE(list.begin().is_end());
+
+        fill_range(list, 0, N_TEST - 1);
+        REQUIRE(list.front_value() == 0);
+        REQUIRE(list.back_value() == N_TEST - 1);
+
+        auto it = list.begin();
+        static_assert(noexcept(it.move_next()));
+        REQUIRE(!it.move_prev());
+        int n = 0;
+        while (!it.is_end()) {
+            REQUIRE(*it == n++);
+            it.move_next();
+        }
+        REQUIRE(n == N_TEST);
+        REQUIRE(!it.move_next());
+        REQUIRE(it.move_prev() && *it == N_TEST - 1);
+
+        try {
+            consistent_linked_list<int>().front();
+            REQUIRE(false);
+        } catch (const std::exception &e) {
+            REQUIRE(string(e.what()) == "List size is 0.");
+        }
+    }
+
+    void compound_ops() {
+        test_case = "compound_ops";
+        consistent_linked_list<int> list;
+        REQUIRE(!list.pop_last_value());
+        REQUIRE(!list.erase_and_get(list.end()));
+        REQUIRE(!list.replace(list.end(), 1));
+
+        fill_range(list, 0, N_TEST - 1);
+        REQUIRE(list.pop_last_value() == N_TEST - 1);
+
+        auto it = list.find(1);
+        REQUIRE(list.replace(it, -1) == 1);
+        REQUIRE(*it == -1);
+        REQUIRE(!list.compare_and_erase(it, 1));
+        REQUIRE(list.compare_and_erase(it, -1));
+        REQUIRE(!list.compare_and_erase(it, -1));
+        REQUIRE(!list.replace(it, 1));
+        REQUIRE(!list.erase_and_get(it));
+
+        REQUIRE(list.erase_and_get(list.find(2)) == 2);
+        REQUIRE(list.size() == N_TEST - 3);
+
+        REQUIRE(!list.insert_if_absent(0));
+        REQUIRE(list.insert_if_absent(N_TEST));
+        REQUIRE(list.back() == N_TEST);
+        REQUIRE(list.size() == N_TEST - 2);
+    }
+
+    void positional_insert() {
+        test_case = "positional_insert";
+        consistent_linked_list<int> list;
+
+        list.insert_before(list.end(), 2);
+        list.insert_after(list.end(), 0);
+        auto it = list.insert_after(list.find(0), 1);
+        REQUIRE(*it == 1);
+        list.insert_after(list.find(2), 4);
+        REQUIRE(*list.emplace_at(list.find(4), 3) == 3);
+        REQUIRE(list.to_vector() == vector<int>({0, 1, 2, 3, 4}));
+        REQUIRE(list.front() == 0 && list.back() == 4);
+
+        // it points at a tombstone now: before goes in front of the next live
+        // node, after goes behind the previous live node.
+        list.erase(1);
+        list.erase(2);
+        list.insert_before(it, -1);
+        list.insert_after(it, -2);
+        REQUIRE(list.to_vector() == vector<int>({0, -2, -1, 3, 4}));
+
+        consistent_linked_list<string> strings;
+        strings.emplace_at(strings.end(), 3, 'x');
+        REQUIRE(strings.front() == "xxx");
+    }
+
+    void splice_split_merge() {
+        test_case = "splice_split_merge";
+        consistent_linked_list<int> a;
+        consistent_linked_list<int> b;
+        fill_range(a, 0, 9);
+        fill_range(b, 10, 19);
+
+        auto moved = b.find(12);
+        a.splice(a.find(5), b, b.find(11), b.find(14));
+        REQUIRE(a.to_vector() == vector<int>({0, 1, 2, 3, 4, 11, 12, 13, 5, 6, 7, 8, 9}));
+        REQUIRE(b.to_vector() == vector<int>({10, 14, 15, 16, 17, 18, 19}));
+        REQUIRE(a.size() == 13 && b.size() == 7);
+
+        // moved now lives in a: it walks a and erases from a.
+        REQUIRE(*(++moved) == 13);
+        REQUIRE(*(++moved) == 5);
+        moved.erase();
+        REQUIRE(!a.contain(5) && a.size() == 12);
+        REQUIRE(*(--moved) == 13);
+
+        auto tail = a.split_at(a.find(7));
+        REQUIRE(tail.to_vector() == vector<int>({7, 8, 9}));
+        REQUIRE(a.to_vector() == vector<int>({0, 1, 2, 3, 4, 11, 12, 13, 6}));
+
+        // A tombstone of b still leads to 10 and 15, so they are copied
+        // instead of moved and the iterator stays in b.
+        {
+            auto pinned = b.find(14);
+            b.erase(14);
+            tail.splice(tail.end(), b);
+            REQUIRE(++pinned == b.end());
+        }
+        REQUIRE(b.empty());
+        REQUIRE(tail.to_vector() == vector<int>({7, 8, 9, 10, 15, 16, 17, 18, 19}));
+
+        consistent_linked_list<int> odd(vector<int>({1, 3, 5, 7}));
+        consistent_linked_list<int> even(vector<int>({0, 2, 4, 6, 8}));
+        odd.merge(even);
+        REQUIRE(odd.to_vector() == vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8}));
+        REQUIRE(even.empty() && odd.size() == 9);
+        REQUIRE(odd.front() == 0 && odd.back() == 8);
+
+        // comp throws on its 4th call: both locks are released, what moved
+        // stays moved, and 0, copied because a tombstone leads to it, is gone from b.
+        {
+            consistent_linked_list<int> a(vector<int>({1, 3, 5, 7}));
+            consistent_linked_list<int> b(vector<int>({-1, 0, 2, 4, 6, 8}));
+            auto pinned = b.begin();
+            b.erase(pinned);
+            int n_calls = 0;
+            bool comp_thrown = false;
+            try {
+                a.merge(b, [&](int x, int y) {
+                    if (++n_calls == 4) {
+                        throw runtime_error("comp");
+                    }
+                    return x < y;
+                });
+            } catch (const runtime_error &) {
+                comp_thrown = true;
+            }
+            REQUIRE(comp_thrown);
+            REQUIRE(a.try_push_back(9) == list_status::ok);
+            REQUIRE(b.try_push_back(10) == list_status::ok);
+            REQUIRE(a.to_vector() == vector<int>({0, 1, 2, 3, 5, 7, 9}));
+            REQUIRE(b.to_vector() == vector<int>({4, 6, 8, 10}));
+            REQUIRE(*(++pinned) == 4);
+        }
+
+        bool thrown = false;
+        try {
+            odd.erase(tail.begin());
+        } catch (const consistent_linked_list_exception &) {
+            thrown = true;
+        }
+        REQUIRE(thrown);
+    }
+
+    void range_erase() {
+        test_case = "range_erase";
+        consistent_linked_list<int> list;
+        fill_range(list, 0, N_TEST - 1);
+
+        REQUIRE(list.erase(list.find(10), list.find(20)) == 10);
+        REQUIRE(list.size() == N_TEST - 10);
+        REQUIRE(list.erase(list.find(5), list.find(5)) == 0);
+
+        // Iterators inside the purged range keep their nodes as tombstones.
+        auto kept = list.find(51);
+        REQUIRE(list.erase_if([](int v) { return v % 2 == 1; }) == (N_TEST - 10) / 2);
+        REQUIRE(list.size() == (N_TEST - 10) / 2);
+        REQUIRE(*kept == 51);
+        REQUIRE(*(++kept) == 52);
+        REQUIRE(list.front() == 0 && list.back() == N_TEST - 2);
+
+        REQUIRE(list.erase(list.begin(), list.end()) == (N_TEST - 10) / 2);
+        REQUIRE(list.empty());
+        REQUIRE(list.erase_if([](int) { return true; }) == 0);
+
+        fill_range(list, 0, N_TEST - 1);
+        bool thrown = false;
+        try {
+            list.erase_if([](int v) -> bool {
+                if (v == N_TEST / 2) {
+                    throw runtime_error("pred");
+                }
+                return v < N_TEST / 2;
+            });
+        } catch (const runtime_error &) {
+            thrown = true;
+        }
+        REQUIRE(thrown);
+        REQUIRE(list.size() == N_TEST / 2 && list.front() == N_TEST / 2);
+        list.push_front(-1);
+        REQUIRE(list.to_vector().size() == N_TEST / 2 + 1);
+    }
+
+    void erase_all() {
+        test_case = "erase_all";
+        consistent_linked_list<int> list;
+        fill_range(list, 0, N_TEST - 1);
+        fill_range(list, 0, N_TEST - 1);
+
+        REQUIRE(list.erase_all(vector<int>({1, 2, 2, N_TEST}), erase_mode::first) == 2);
+        REQUIRE(list.size() == 2 * N_TEST - 2);
+        REQUIRE(list.contain(1) && list.contain(2));
+
+        REQUIRE(list.erase_all(vector<int>({1, 2, 3})) == 4);
+        REQUIRE(!list.contain(1) && !list.contain(2) && !list.contain(3));
+        REQUIRE(list.erase_all(vector<int>()) == 0);
+
+        vector<int> evens;
+        for (int i = 0; i < N_TEST; i += 2) {
+            evens.push_back(i);
+        }
+        list.erase_all(evens);
+        for (int v : list.to_vector()) {
+            REQUIRE(v % 2 == 1);
+        }
+    }
+
+    void find_from() {
+        test_case = "find_from";
+        consistent_linked_list<int> list;
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i % 10);
+        }
+
+        auto it = list.find(3);
+        REQUIRE(list.find_from(it, 3) == it);
+        int n = 0;
+        for (; it != list.end(); it = list.find_from(++it, 3)) {
+            n++;
+        }
+        REQUIRE(n == N_TEST / 10);
+
+        auto big = list.find_if_from(list.find(9), [](int v) { return v > 9; });
+        REQUIRE(big == list.end());
+        auto five = list.find_if_from(list.find(7), [](int v) { return v == 5; });
+        REQUIRE(*five == 5);
+        REQUIRE(*(--five) == 4);
+
+        n = 0;
+        for (int v : list.matches(7)) {
+            REQUIRE(v == 7);
+            n++;
+        }
+        REQUIRE(n == N_TEST / 10);
+
+        // Erasing the current match turns it into a tombstone, paging goes on after it.
+        auto range = list.matches(2);
+        n = 0;
+        for (auto m = range.begin(); m != range.end(); ++m) {
+            list.erase(m.position());
+            n++;
+        }
+        REQUIRE(n == N_TEST / 10);
+        REQUIRE(!list.contain(2));
+    }
+
+    void find_both_ends() {
+        test_case = "find_both_ends";
+        // Every length, with the value at every pair of positions: find must
+        // return the first one whichever end reaches a match first.
+        for (int n = 0; n < 12; ++n) {
+            for (int i = 0; i <= n; ++i) {
+                for (int j = i; j <= n; ++j) {
+                    consistent_linked_list<int> list;
+                    for (int k = 0; k < n; ++k) {
+                        list.push_back(k == i || k == j ? -1 : k);
+                    }
+                    auto it = list.find(-1);
+                    if (i == n) {
+                        REQUIRE(it == list.end());
+                        REQUIRE(!list.contain(-1));
+                        continue;
+                    }
+                    int pos = 0;
+                    for (auto walk = list.begin(); walk != it; ++walk) {
+                        pos++;
+                    }
+                    REQUIRE(pos == i);
+                    auto second = list.find_from(++it, -1);
+                    if (j == i || j == n) {
+                        REQUIRE(second == list.end());
+                    } else {
+                        for (; it != second; ++it) {
+                            pos++;
+                        }
+                        REQUIRE(pos + 1 == j);
+                    }
+
+                    vector<int> expected;
+                    for (int k = 0; k < n; ++k) {
+                        expected.push_back(k == i || k == j ? -1 : k);
+                    }
+                    REQUIRE(list.to_vector() == expected);
+                }
+            }
+        }
+    }
+
+    void arena() {
+        test_case = "arena";
+        using arena_list = consistent_linked_list<int, mutex_lock, plain_ref_count, huge_page_arena>;
+        // Enough nodes for a few chunks, so freed slots get reused across them.
+        const int N_NODES = 200000;
+
+        arena_list a;
+        for (int i = 0; i < N_NODES; ++i) {
+            a.push_back(i);
+        }
+        REQUIRE(a.size() == N_NODES);
+        REQUIRE(a.nodes_on_huge_pages() <= N_NODES + 1);
+
+        auto pinned = a.find(N_NODES / 2);
+        REQUIRE(a.erase_if([](int v) { return v % 2 == 0; }) == N_NODES / 2);
+        REQUIRE(*pinned == N_NODES / 2);
+        REQUIRE(*(++pinned) == N_NODES / 2 + 1);
+        for (int i = 0; i < N_NODES / 2; ++i) {
+            a.push_front(-i);
+        }
+
+        arena_list b;
+        b.splice(b.end(), a);
+        REQUIRE(a.empty());
+        REQUIRE(b.size() == N_NODES);
+        REQUIRE(b.front() == -(N_NODES / 2 - 1));
+        REQUIRE(b.back() == N_NODES - 1);
+
+        consistent_linked_list<int> heap;
+        heap.push_back(1);
+        REQUIRE(heap.nodes_on_huge_pages() == 0);
+    }
+
+    // Records whether the list was still locked when it trimmed.
+    struct trim_probe : heap_allocation {
+        static inline spin_lock *list_lock = nullptr;
+        static inline int n_trims = 0;
+        static inline bool trimmed_under_lock = false;
+
+        template<size_t Size, size_t Align>
+        static size_t release_unused() {
+            n_trims++;
+            if (list_lock->try_lock()) {
+                list_lock->unlock();
+            } else {
+                trimmed_under_lock = true;
+            }
+            return 0;
+        }
+    };
+
+    void trim() {
+        test_case = "trim";
+        using arena_list = consistent_linked_list<int, mutex_lock, plain_ref_count, huge_page_arena>;
+        const int N_NODES = 200000;
+
+        arena_list list;
+        for (int i = 0; i < N_NODES; ++i) {
+            list.push_back(i);
+        }
+        auto tombstone = list.find(N_NODES / 2);
+        auto last = list.find(N_NODES - 1);
+        list.erase_if([](int v) { return v != N_NODES - 1; });
+        REQUIRE(list.size() == 1);
+
+        // Only the chunks of END_NODE, the tombstone and what it pins stay.
+        REQUIRE(list.trim() > 0);
+        REQUIRE(list.trim() == 0);
+        REQUIRE(*tombstone == N_NODES / 2);
+        REQUIRE(++tombstone == last);
+        REQUIRE(*last == N_NODES - 1);
+
+        // Crossing the mark trims by itself, so nothing is left to release.
+        list.set_low_water_mark(10);
+        for (int i = 0; i < N_NODES; ++i) {
+            list.push_back(i);
+        }
+        while (list.size() > 10) {
+            list.pop_first();
+        }
+        REQUIRE(list.trim() == 0);
+
+        consistent_linked_list<int> heap;
+        heap.push_back(1);
+        REQUIRE(heap.trim() == 0);
+        REQUIRE(heap.front() == 1);
+
+        // The low water mark trims after the list is unlocked.
+        consistent_linked_list<int, spin_lock, plain_ref_count, trim_probe> probed;
+        trim_probe::list_lock = &probed.get_lock_policy();
+        probed.set_low_water_mark(1);
+        probed.push_back(1);
+        probed.push_back(2);
+        probed.pop_first();
+        REQUIRE(trim_probe::n_trims == 1);
+        REQUIRE(!trim_probe::trimmed_under_lock);
+    }
+
     void start() {
         push_back();
         push_front();
@@ -297,6 +913,24 @@ namespace func_tests {
         contain();
         to_vector();
         find();
+        pop_value();
+        capacity();
+        capacity_bytes();
+        policies();
+        iterator_erase();
+        tombstone_chain();
+        parked_iterator();
+        try_ops();
+        noexcept_api();
+        compound_ops();
+        positional_insert();
+        splice_split_merge();
+        range_erase();
+        erase_all();
+        find_from();
+        find_both_ends();
+        arena();
+        trim();
 
         cout << "Function tests passed. Nice!" << endl;
     }
@@ -0,0 +1,536 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Lock policies for consistent_linked_list. A policy is any type with
+// lock()/unlock()/try_lock(); the list stores one instance and calls it
+// directly, so an empty policy costs nothing after inlining.
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Exponential backoff for spin loops. Past the spin budget it yields, so a
+// spinner does not burn its whole time slice when threads outnumber cores.
+class backoff {
+private:
+    static const int MAX_PAUSES = 32;
+    static const int YIELD_AFTER = 256;
+
+    int pauses = 1;
+    int spent = 0;
+
+public:
+    void pause() {
+        if (spent >= YIELD_AFTER) {
+            std::this_thread::yield();
+            return;
+        }
+        for (int i = 0; i < pauses; i++) {
+            cpu_relax();
+        }
+        spent += pauses;
+        if (pauses < MAX_PAUSES) {
+            pauses <<= 1;
+        }
+    }
+
+    bool spin_budget_spent() const {
+        return spent >= YIELD_AFTER;
+    }
+};
+
+// Single-threaded use: every call is a no-op.
+class null_lock {
+public:
+    void lock() {}
+
+    void unlock() {}
+
+    bool try_lock() {
+        return true;
+    }
+};
+
+// Test-and-test-and-set lock, not recursive.
+class spin_lock {
+private:
+    std::atomic<bool> locked{false};
+
+public:
+    void lock() {
+        backoff b;
+        while (locked.exchange(true, std::memory_order_acquire)) {
+            while (locked.load(std::memory_order_relaxed)) {
+                b.pause();
+            }
+        }
+    }
+
+    void unlock() {
+        locked.store(false, std::memory_order_release);
+    }
+
+    bool try_lock() {
+        return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+    }
+};
+
+// Spins with exponential backoff while the holder is likely to finish soon,
+// then parks the thread on a futex. state: 0 free, 1 locked, 2 locked and
+// somebody may be parked.
+class adaptive_lock {
+private:
+    std::atomic<int> state{0};
+
+    void park() {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<int *>(&state), FUTEX_WAIT_PRIVATE, 2, nullptr, nullptr, 0);
+#else
+        state.wait(2, std::memory_order_relaxed);
+#endif
+    }
+
+    void wake_one() {
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<int *>(&state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        state.notify_one();
+#endif
+    }
+
+public:
+    void lock() {
+        int expected = 0;
+        if (state.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+            return;
+        }
+
+        backoff b;
+        while (!b.spin_budget_spent()) {
+            b.pause();
+            expected = 0;
+            if (state.load(std::memory_order_relaxed) == 0 &&
+                state.compare_exchange_weak(expected, 1, std::memory_order_acquire)) {
+                return;
+            }
+        }
+
+        while (state.exchange(2, std::memory_order_acquire) != 0) {
+            park();
+        }
+    }
+
+    void unlock() {
+        if (state.exchange(0, std::memory_order_release) == 2) {
+            wake_one();
+        }
+    }
+
+    bool try_lock() {
+        int expected = 0;
+        return state.compare_exchange_strong(expected, 1, std::memory_order_acquire);
+    }
+};
+
+// FIFO lock: threads enter in the order they took a ticket.
+class ticket_lock {
+private:
+    alignas(64) std::atomic<size_t> next_ticket{0};
+    alignas(64) std::atomic<size_t> now_serving{0};
+
+public:
+    void lock() {
+        size_t ticket = next_ticket.fetch_add(1, std::memory_order_relaxed);
+        backoff b;
+        while (now_serving.load(std::memory_order_acquire) != ticket) {
+            b.pause();
+        }
+    }
+
+    void unlock() {
+        now_serving.store(now_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_lock() {
+        size_t serving = now_serving.load(std::memory_order_acquire);
+        size_t ticket = serving;
+        return next_ticket.compare_exchange_strong(ticket, serving + 1, std::memory_order_acquire);
+    }
+};
+
+// MCS queue lock: FIFO like ticket_lock, but every waiter spins on its own
+// queue node, so a handoff touches one remote cache line instead of all.
+class mcs_lock {
+private:
+    class alignas(64) queue_node {
+    public:
+        std::atomic<queue_node *> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    std::atomic<queue_node *> tail{nullptr};
+    // Node of the current owner, only touched by the owner.
+    queue_node *holder = nullptr;
+
+    // Queue nodes are reused per thread; one thread may hold several locks.
+    static std::vector<std::unique_ptr<queue_node>> &node_pool() {
+        static thread_local std::vector<std::unique_ptr<queue_node>> pool;
+        return pool;
+    }
+
+    static queue_node *take_node() {
+        auto &pool = node_pool();
+        if (pool.empty()) {
+            return new queue_node();
+        }
+        queue_node *node = pool.back().release();
+        pool.pop_back();
+        return node;
+    }
+
+    static void give_back(queue_node *node) {
+        node_pool().emplace_back(node);
+    }
+
+public:
+    void lock() {
+        queue_node *me = take_node();
+        me->next.store(nullptr, std::memory_order_relaxed);
+        me->locked.store(true, std::memory_order_relaxed);
+
+        queue_node *prev = tail.exchange(me, std::memory_order_acq_rel);
+        if (prev != nullptr) {
+            prev->next.store(me, std::memory_order_release);
+            backoff b;
+            while (me->locked.load(std::memory_order_acquire)) {
+                b.pause();
+            }
+        }
+        holder = me;
+    }
+
+    void unlock() {
+        queue_node *me = holder;
+        queue_node *succ = me->next.load(std::memory_order_acquire);
+        if (succ == nullptr) {
+            queue_node *expected = me;
+            if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+                give_back(me);
+                return;
+            }
+            // A successor swapped the tail but has not linked itself yet.
+            while ((succ = me->next.load(std::memory_order_acquire)) == nullptr) {
+                cpu_relax();
+            }
+        }
+        succ->locked.store(false, std::memory_order_release);
+        give_back(me);
+    }
+
+    bool try_lock() {
+        queue_node *me = take_node();
+        me->next.store(nullptr, std::memory_order_relaxed);
+        queue_node *expected = nullptr;
+        if (tail.compare_exchange_strong(expected, me, std::memory_order_acq_rel)) {
+            holder = me;
+            return true;
+        }
+        give_back(me);
+        return false;
+    }
+};
+
+using mutex_lock = std::mutex;
+using shared_mutex_lock = std::shared_mutex;
+
+enum class lock_mode {
+    mutex,
+    // Readers share the lock, for read-heavy phases.
+    reader_writer,
+    // adaptive_lock, for bursts of short writes where parking costs more than spinning.
+    spin_then_park
+};
+
+// Measures its own contention and moves between a plain mutex, a
+// reader-writer lock and adaptive_lock. Every WINDOW exclusive acquisitions
+// the holder looks at the share of reads, how often the lock was taken with
+// a wait and how long those waits were, and switches if another mode fits
+// better. The mode only changes while the switching thread holds the lock
+// of the current mode exclusively, so a holder always releases what it took.
+class contention_adaptive_lock {
+private:
+    static const size_t WINDOW = 1024;
+    static const size_t SHORT_WAIT_NS = 20000;
+
+    std::atomic<lock_mode> current{lock_mode::mutex};
+    std::mutex plain;
+    std::shared_mutex rw;
+    adaptive_lock spin_park;
+
+    std::atomic<size_t> n_acquired{0};
+    std::atomic<size_t> n_shared{0};
+    std::atomic<size_t> n_contended{0};
+    std::atomic<size_t> wait_ns{0};
+    std::atomic<size_t> n_switches{0};
+
+    void lock_in(lock_mode mode) {
+        switch (mode) {
+            case lock_mode::mutex:
+                plain.lock();
+                break;
+            case lock_mode::reader_writer:
+                rw.lock();
+                break;
+            case lock_mode::spin_then_park:
+                spin_park.lock();
+                break;
+        }
+    }
+
+    bool try_lock_in(lock_mode mode) {
+        switch (mode) {
+            case lock_mode::mutex:
+                return plain.try_lock();
+            case lock_mode::reader_writer:
+                return rw.try_lock();
+            case lock_mode::spin_then_park:
+                return spin_park.try_lock();
+        }
+        return false;
+    }
+
+    void unlock_in(lock_mode mode) {
+        switch (mode) {
+            case lock_mode::mutex:
+                plain.unlock();
+                break;
+            case lock_mode::reader_writer:
+                rw.unlock();
+                break;
+            case lock_mode::spin_then_park:
+                spin_park.unlock();
+                break;
+        }
+    }
+
+    template<typename TryLock, typename Lock>
+    void timed_acquire(TryLock try_lock_, Lock lock_) {
+        if (try_lock_()) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        lock_();
+        auto waited = std::chrono::steady_clock::now() - start;
+        n_contended.fetch_add(1, std::memory_order_relaxed);
+        wait_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count(),
+                          std::memory_order_relaxed);
+    }
+
+    // Takes the lock of the current mode exclusively and returns that mode.
+    lock_mode lock_exclusive() {
+        while (true) {
+            lock_mode mode = current.load(std::memory_order_acquire);
+            timed_acquire([&] { return try_lock_in(mode); }, [&] { lock_in(mode); });
+            // The mode cannot change any more: that needs the lock we hold.
+            if (current.load(std::memory_order_relaxed) == mode) {
+                return mode;
+            }
+            unlock_in(mode);
+        }
+    }
+
+    lock_mode choose(size_t n, size_t shared, size_t contended, size_t waited) const {
+        lock_mode mode = current.load(std::memory_order_relaxed);
+        // An uncontended lock is cheap in any mode, switching is not.
+        if (contended * 10 < n) {
+            return mode;
+        }
+        if (shared * 4 >= n * 3) {
+            return lock_mode::reader_writer;
+        }
+        if (waited / contended < SHORT_WAIT_NS) {
+            return lock_mode::spin_then_park;
+        }
+        return lock_mode::mutex;
+    }
+
+    // Caller holds the lock of the current mode exclusively and holds the
+    // lock of the new mode exclusively afterwards. Late arrivals that took
+    // the old lock see the new mode and retry.
+    void switch_mode(lock_mode next) {
+        lock_mode mode = current.load(std::memory_order_relaxed);
+        if (next == mode) {
+            return;
+        }
+        lock_in(next);
+        current.store(next, std::memory_order_release);
+        unlock_in(mode);
+        n_switches.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void adapt() {
+        size_t n = n_acquired.load(std::memory_order_relaxed);
+        if (n < WINDOW) {
+            return;
+        }
+        n_acquired.store(0, std::memory_order_relaxed);
+        size_t shared = n_shared.exchange(0, std::memory_order_relaxed);
+        size_t contended = n_contended.exchange(0, std::memory_order_relaxed);
+        size_t waited = wait_ns.exchange(0, std::memory_order_relaxed);
+        switch_mode(choose(n, shared, contended, waited));
+    }
+
+public:
+    void lock() {
+        lock_exclusive();
+        n_acquired.fetch_add(1, std::memory_order_relaxed);
+        adapt();
+    }
+
+    void unlock() {
+        unlock_in(current.load(std::memory_order_relaxed));
+    }
+
+    bool try_lock() {
+        lock_mode mode = current.load(std::memory_order_acquire);
+        if (!try_lock_in(mode)) {
+            return false;
+        }
+        if (current.load(std::memory_order_relaxed) != mode) {
+            unlock_in(mode);
+            return false;
+        }
+        n_acquired.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Outside of reader_writer mode readers take the lock exclusively, but are
+    // still counted, so that a read-heavy phase is noticed.
+    void lock_shared() {
+        n_shared.fetch_add(1, std::memory_order_relaxed);
+        n_acquired.fetch_add(1, std::memory_order_relaxed);
+        while (true) {
+            lock_mode mode = current.load(std::memory_order_acquire);
+            if (mode == lock_mode::reader_writer) {
+                timed_acquire([&] { return rw.try_lock_shared(); }, [&] { rw.lock_shared(); });
+                if (current.load(std::memory_order_relaxed) == lock_mode::reader_writer) {
+                    return;
+                }
+                rw.unlock_shared();
+                continue;
+            }
+
+            lock_exclusive();
+            adapt();
+            if (current.load(std::memory_order_relaxed) != lock_mode::reader_writer) {
+                return;
+            }
+            // Just switched to reader_writer: trade the exclusive lock for a shared one.
+            rw.unlock();
+        }
+    }
+
+    void unlock_shared() {
+        if (current.load(std::memory_order_relaxed) == lock_mode::reader_writer) {
+            rw.unlock_shared();
+        } else {
+            unlock();
+        }
+    }
+
+    lock_mode mode() const {
+        return current.load(std::memory_order_relaxed);
+    }
+
+    size_t switches() const {
+        return n_switches.load(std::memory_order_relaxed);
+    }
+
+    // Pins the lock to a mode until the next contended window moves it again.
+    void switch_to(lock_mode next) {
+        lock_exclusive();
+        switch_mode(next);
+        unlock();
+    }
+};
+
+// Condition variable to pair with a lock policy. Waiting under null_lock
+// could never be woken up, so it throws instead.
+template<typename LockPolicy>
+class lock_condition : public std::condition_variable_any {
+};
+
+template<>
+class lock_condition<null_lock> {
+public:
+    void notify_one() {}
+
+    void notify_all() {}
+
+    void wait(null_lock &) {
+        throw std::logic_error("Blocking wait on a list without a lock.");
+    }
+
+    template<typename Clock, typename Duration>
+    std::cv_status wait_until(null_lock &, const std::chrono::time_point<Clock, Duration> &) {
+        return std::cv_status::timeout;
+    }
+};
+
+// Alignment a list gives its lock, its state and its other field groups,
+// so that each starts a cache line of its own. A list without a lock has
+// no contention to keep apart and stays compact. 0 means no padding.
+template<typename LockPolicy>
+struct cache_line_padding {
+    static constexpr size_t value = 64;
+};
+
+template<>
+struct cache_line_padding<null_lock> {
+    static constexpr size_t value = 0;
+};
+
+// Reference count policies for list nodes.
+class plain_ref_count {
+public:
+    using type = int;
+
+    static int add(type &count, int value) {
+        return count += value;
+    }
+
+    static int load(const type &count) {
+        return count;
+    }
+};
+
+class atomic_ref_count {
+public:
+    using type = std::atomic<int>;
+
+    static int add(type &count, int value) {
+        return count.fetch_add(value, std::memory_order_acq_rel) + value;
+    }
+
+    static int load(const type &count) {
+        return count.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "consistent_linked_list.h"
+
+// Many threads call push_back, exactly one thread pops or drains. Producers
+// append with a single atomic exchange on the tail (Vyukov's MPSC queue) and
+// never wait for each other or for the consumer.
+template<typename T>
+class mpsc_consistent_linked_list {
+private:
+    class Node {
+    public:
+        Node() = default;
+
+        explicit Node(const T &t) : value(t) {}
+
+        T value = T();
+        std::atomic<Node *> next{nullptr};
+    };
+
+    // Producer side: the last node handed out by exchange.
+    alignas(64) std::atomic<Node *> tail;
+    std::atomic<size_t> n_pushed{0};
+
+    // Consumer side: a dummy, live elements start at head->next.
+    alignas(64) Node *head;
+    std::atomic<size_t> n_popped{0};
+
+    // Takes the next published node, the old dummy is freed.
+    Node *advance() {
+        Node *next = head->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return nullptr;
+        }
+        delete head;
+        head = next;
+        return next;
+    }
+
+public:
+    mpsc_consistent_linked_list() {
+        head = new Node();
+        tail.store(head, std::memory_order_relaxed);
+    }
+
+    ~mpsc_consistent_linked_list() {
+        while (advance() != nullptr) {}
+        delete head;
+    }
+
+    // Producers. A node becomes visible to the consumer once the previous
+    // producer's link is stored, so a consumer may briefly see fewer elements.
+    void push_back(const T &value) {
+        Node *new_node = new Node(value);
+        n_pushed.fetch_add(1, std::memory_order_relaxed);
+        Node *prev = tail.exchange(new_node, std::memory_order_acq_rel);
+        prev->next.store(new_node, std::memory_order_release);
+    }
+
+    // Consumer.
+    std::optional<T> pop_first_value() {
+        Node *node = advance();
+        if (node == nullptr) {
+            return std::nullopt;
+        }
+        n_popped.fetch_add(1, std::memory_order_relaxed);
+        return std::move(node->value);
+    }
+
+    // Consumer. Moves every published element into out, returns how many.
+    size_t drain_all(std::vector<T> &out) {
+        size_t n = 0;
+        for (Node *node = advance(); node != nullptr; node = advance()) {
+            out.push_back(std::move(node->value));
+            n++;
+        }
+        n_popped.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    // Consumer. Appends every published element to out under one lock of out.
+    template<typename LockPolicy, typename RefCountPolicy, typename AllocationPolicy>
+    size_t drain_all(consistent_linked_list<T, LockPolicy, RefCountPolicy, AllocationPolicy> &out) {
+        std::vector<T> v;
+        size_t n = drain_all(v);
+        out.append(v.begin(), v.end());
+        return n;
+    }
+
+    bool empty() {
+        return head->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    // Includes pushes still being linked.
+    size_t size() {
+        size_t popped = n_popped.load(std::memory_order_relaxed);
+        return n_pushed.load(std::memory_order_relaxed) - popped;
+    }
+};
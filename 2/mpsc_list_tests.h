@@ -0,0 +1,97 @@
+#pragma once
+
+#include "iostream"
+#include "vector"
+#include <thread>
+
+#include "mpsc_consistent_linked_list.h"
+
+namespace mpsc_list_tests {
+    using namespace std;
+
+    const int N_TEST = 100;
+    int N_THREADS = 4;
+
+    string test_case = "NULL";
+
+    void REQUIRE(bool b) {
+        if (!b) {
+            throw runtime_error("Fail. Test: " + test_case);
+        }
+    }
+
+    void pop_and_drain() {
+        test_case = "pop_and_drain";
+
+        mpsc_consistent_linked_list<int> list;
+        REQUIRE(list.empty());
+        REQUIRE(!list.pop_first_value());
+
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+        }
+        REQUIRE(list.size() == N_TEST);
+        REQUIRE(*list.pop_first_value() == 0);
+
+        vector<int> v;
+        REQUIRE(list.drain_all(v) == N_TEST - 1);
+        REQUIRE(list.empty());
+        for (int i = 1; i < N_TEST; ++i) {
+            REQUIRE(v[i - 1] == i);
+        }
+
+        consistent_linked_list<int> out;
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+        }
+        REQUIRE(list.drain_all(out) == N_TEST);
+        REQUIRE(out.size() == N_TEST);
+        REQUIRE(out.front() == 0 && out.back() == N_TEST - 1);
+        REQUIRE(list.size() == 0);
+    }
+
+    void producers() {
+        test_case = "producers";
+
+        mpsc_consistent_linked_list<int> list;
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    list.push_back(i * N_TEST + j);
+                }
+            });
+        }
+
+        vector<int> v;
+        while (v.size() < (size_t) (N_THREADS * N_TEST)) {
+            if (list.drain_all(v) == 0) {
+                this_thread::yield();
+            }
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        // Values from one producer arrive in push order.
+        vector<int> last(N_THREADS, -1);
+        for (int x : v) {
+            int owner = x / N_TEST;
+            REQUIRE(x > last[owner]);
+            last[owner] = x;
+        }
+        for (int i = 0; i < N_THREADS; ++i) {
+            REQUIRE(last[i] == (i + 1) * N_TEST - 1);
+        }
+        REQUIRE(list.empty());
+    }
+
+    void start() {
+        pop_and_drain();
+        producers();
+
+        std::cout << "MPSC list tests passed. Nice!" << endl;
+    }
+}
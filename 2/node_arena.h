@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// Node allocation policies for consistent_linked_list. A policy has static
+// allocate<Size, Align>(), deallocate<Size, Align>(p),
+// nodes_on_huge_pages<Size, Align>() and release_unused<Size, Align>(). All
+// lists with the same node type share one pool, so a node spliced into
+// another list can be freed by it.
+
+// Plain operator new/delete.
+class heap_allocation {
+public:
+    template<size_t Size, size_t Align>
+    static void *allocate() {
+        if constexpr (Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return ::operator new(Size, std::align_val_t(Align));
+        } else {
+            return ::operator new(Size);
+        }
+    }
+
+    template<size_t Size, size_t Align>
+    static void deallocate(void *p) {
+        if constexpr (Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(p, std::align_val_t(Align));
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    template<size_t Size, size_t Align>
+    static size_t nodes_on_huge_pages() {
+        return 0;
+    }
+
+    // Asks malloc to give free memory back, which it does not report in
+    // bytes, so this always returns 0.
+    template<size_t Size, size_t Align>
+    static size_t release_unused() {
+#ifdef __GLIBC__
+        malloc_trim(0);
+#endif
+        return 0;
+    }
+};
+
+// Nodes are carved out of 2MB chunks aligned to 2MB. On Linux each chunk is
+// mmapped and advised with MADV_HUGEPAGE, so with transparent huge pages in
+// "madvise" or "always" mode it is backed by one huge page and a traversal
+// takes one TLB entry per chunk instead of one per 4KB. If mmap fails, or
+// elsewhere, chunks come from aligned_alloc and use regular pages.
+class huge_page_arena {
+public:
+    static const size_t CHUNK_SIZE = size_t(2) << 20;
+
+private:
+    // Sits at the start of its chunk, a node finds it by rounding its
+    // address down to CHUNK_SIZE.
+    struct chunk {
+        void *free_slots = nullptr;
+        size_t n_carved = 0;
+        size_t n_live = 0;
+        bool is_mapped = false;
+    };
+
+    static const size_t HEADER_SIZE = 64;
+
+    class pool {
+    private:
+        std::mutex m;
+        size_t slot_size;
+        size_t n_slots;
+        std::vector<chunk *> chunks;
+        // Chunks that had a free slot when they were pushed, the one being
+        // carved from excluded.
+        std::vector<chunk *> with_room;
+        chunk *current = nullptr;
+
+        bool has_room(chunk *c) const {
+            return c->free_slots != nullptr || c->n_carved < n_slots;
+        }
+
+        static chunk *map_chunk() {
+            void *p = nullptr;
+            bool is_mapped = false;
+#ifdef __linux__
+            // Twice the size, then the unaligned ends are given back.
+            void *raw = mmap(nullptr, 2 * CHUNK_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw != MAP_FAILED) {
+                uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+                uintptr_t aligned = (start + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1);
+                if (aligned > start) {
+                    munmap(raw, aligned - start);
+                }
+                munmap(reinterpret_cast<void *>(aligned + CHUNK_SIZE), start + CHUNK_SIZE - aligned);
+                p = reinterpret_cast<void *>(aligned);
+                is_mapped = true;
+#ifdef MADV_HUGEPAGE
+                // Failing only means regular pages.
+                madvise(p, CHUNK_SIZE, MADV_HUGEPAGE);
+#endif
+            }
+#endif
+            if (p == nullptr) {
+                p = std::aligned_alloc(CHUNK_SIZE, CHUNK_SIZE);
+                if (p == nullptr) {
+                    throw std::bad_alloc();
+                }
+            }
+            chunk *c = new(p) chunk();
+            c->is_mapped = is_mapped;
+            return c;
+        }
+
+        static void unmap_chunk(chunk *c) {
+#ifdef __linux__
+            if (c->is_mapped) {
+                munmap(c, CHUNK_SIZE);
+                return;
+            }
+#endif
+            std::free(c);
+        }
+
+    public:
+        pool(size_t size, size_t align) :
+                slot_size((size + align - 1) & ~(align - 1)),
+                n_slots((CHUNK_SIZE - HEADER_SIZE) / slot_size) {}
+
+        pool(const pool &) = delete;
+
+        void *allocate() {
+            std::lock_guard<std::mutex> guard(m);
+            if (current == nullptr || !has_room(current)) {
+                current = nullptr;
+                while (!with_room.empty() && current == nullptr) {
+                    current = with_room.back();
+                    with_room.pop_back();
+                }
+                if (current == nullptr) {
+                    current = map_chunk();
+                    chunks.push_back(current);
+                }
+            }
+            void *p = current->free_slots;
+            if (p != nullptr) {
+                current->free_slots = *static_cast<void **>(p);
+            } else {
+                p = reinterpret_cast<char *>(current) + HEADER_SIZE + current->n_carved * slot_size;
+                current->n_carved++;
+            }
+            current->n_live++;
+            return p;
+        }
+
+        void deallocate(void *p) {
+            chunk *c = reinterpret_cast<chunk *>(reinterpret_cast<uintptr_t>(p) & ~(CHUNK_SIZE - 1));
+            std::lock_guard<std::mutex> guard(m);
+            bool was_full = !has_room(c);
+            *static_cast<void **>(p) = c->free_slots;
+            c->free_slots = p;
+            c->n_live--;
+            if (was_full && c != current) {
+                with_room.push_back(c);
+            }
+        }
+
+        // Unmaps the chunks without a live node. Tombstones count as live,
+        // so everything an iterator can still reach stays. Returns the bytes
+        // given back.
+        size_t release_unused() {
+            std::lock_guard<std::mutex> guard(m);
+            std::vector<chunk *> kept;
+            size_t released = 0;
+            for (chunk *c : chunks) {
+                if (c->n_live != 0) {
+                    kept.push_back(c);
+                    continue;
+                }
+                if (c == current) {
+                    current = nullptr;
+                }
+                unmap_chunk(c);
+                released += CHUNK_SIZE;
+            }
+            chunks.swap(kept);
+
+            with_room.clear();
+            for (chunk *c : chunks) {
+                if (c != current && has_room(c)) {
+                    with_room.push_back(c);
+                }
+            }
+            return released;
+        }
+
+        // Live nodes in chunks backed by huge pages. The kernel only reports
+        // AnonHugePages per mapping in /proc/self/smaps, and neighbouring
+        // chunks share a mapping, so a partly backed mapping counts its
+        // nodes in proportion.
+        size_t nodes_on_huge_pages() {
+            struct mapping {
+                uintptr_t start;
+                uintptr_t end;
+                size_t size_kb;
+                size_t huge_kb;
+            };
+            std::vector<mapping> mappings;
+            std::ifstream smaps("/proc/self/smaps");
+            std::string line;
+            while (std::getline(smaps, line)) {
+                uintptr_t start;
+                uintptr_t end;
+                char dash;
+                std::istringstream header(line);
+                if (header >> std::hex >> start >> dash >> end && dash == '-') {
+                    mappings.push_back({start, end, 0, 0});
+                } else if (!mappings.empty() && line.compare(0, 5, "Size:") == 0) {
+                    mappings.back().size_kb = std::stoul(line.substr(5));
+                } else if (!mappings.empty() && line.compare(0, 14, "AnonHugePages:") == 0) {
+                    mappings.back().huge_kb = std::stoul(line.substr(14));
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(m);
+            double res = 0;
+            for (chunk *c : chunks) {
+                uintptr_t p = reinterpret_cast<uintptr_t>(c);
+                for (auto &map : mappings) {
+                    if (c->is_mapped && map.start <= p && p < map.end && map.size_kb != 0) {
+                        res += double(c->n_live) * map.huge_kb / map.size_kb;
+                        break;
+                    }
+                }
+            }
+            return size_t(res + 0.5);
+        }
+    };
+
+    // Never destroyed: a list with static storage may free its nodes
+    // after the pool would have been.
+    template<size_t Size, size_t Align>
+    static pool &pool_for() {
+        static_assert(Align <= HEADER_SIZE, "Nodes aligned past a cache line.");
+        static pool *p = new pool(Size, Align);
+        return *p;
+    }
+
+public:
+    template<size_t Size, size_t Align>
+    static void *allocate() {
+        return pool_for<Size, Align>().allocate();
+    }
+
+    template<size_t Size, size_t Align>
+    static void deallocate(void *p) {
+        pool_for<Size, Align>().deallocate(p);
+    }
+
+    template<size_t Size, size_t Align>
+    static size_t nodes_on_huge_pages() {
+        return pool_for<Size, Align>().nodes_on_huge_pages();
+    }
+
+    template<size_t Size, size_t Align>
+    static size_t release_unused() {
+        return pool_for<Size, Align>().release_unused();
+    }
+};
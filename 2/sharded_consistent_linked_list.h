@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "consistent_linked_list.h"
+
+enum class shard_order {
+    // Elements of one shard keep their order, shards are visited one by one.
+    relaxed,
+    // Every element gets a global timestamp, iteration merges shards by it.
+    ordered
+};
+
+template<typename T>
+class sharded_consistent_linked_list {
+private:
+    class stamped_value {
+    public:
+        size_t stamp = 0;
+        T value = T();
+
+        bool operator==(const stamped_value &rhs) const {
+            return stamp == rhs.stamp && value == rhs.value;
+        }
+    };
+
+    using segment = consistent_linked_list<stamped_value>;
+    using segment_iterator = typename segment::consistent_iterator;
+
+    shard_order order;
+    std::vector<std::unique_ptr<segment>> shards;
+    std::atomic<size_t> clock{0};
+
+    segment &local_shard() {
+        size_t h = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return *shards[h % shards.size()];
+    }
+
+    size_t next_stamp() {
+        if (order == shard_order::relaxed) {
+            return 0;
+        }
+        return clock.fetch_add(1, std::memory_order_relaxed);
+    }
+
+public:
+    class consistent_iterator;
+
+    explicit sharded_consistent_linked_list(size_t n_shards = std::thread::hardware_concurrency(),
+                                            shard_order order_ = shard_order::relaxed) : order(order_) {
+        if (n_shards == 0) {
+            n_shards = 1;
+        }
+        for (size_t i = 0; i < n_shards; i++) {
+            shards.emplace_back(new segment());
+        }
+    }
+
+    // The stamp is taken under the shard lock, so every shard stays sorted
+    // by stamp even when threads share a shard.
+    void push_back(const T &value) {
+        stamped_value v;
+        v.value = value;
+        local_shard().push_back_updated(v, [&](stamped_value &linked) {
+            linked.stamp = next_stamp();
+        });
+    }
+
+    void erase(consistent_iterator it) {
+        if (it.shard == shards.size()) {
+            throw consistent_linked_list_exception("Deleted end iterator.");
+        }
+        shards[it.shard]->erase(it.cur[it.shard]);
+    }
+
+    size_t size() {
+        size_t res = 0;
+        for (auto &shard : shards) {
+            res += shard->size();
+        }
+        return res;
+    }
+
+    bool empty() {
+        for (auto &shard : shards) {
+            if (!shard->empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t shard_count() const {
+        return shards.size();
+    }
+
+    shard_order get_order() const {
+        return order;
+    }
+
+    consistent_iterator begin() {
+        return consistent_iterator(this, false);
+    }
+
+    consistent_iterator end() {
+        return consistent_iterator(this, true);
+    }
+
+    // One locked scan per shard.
+    bool contain(const T &value) {
+        auto has_value = [&](const stamped_value &element) { return element.value == value; };
+        for (auto &shard : shards) {
+            if (!shard->find_if_from(shard->begin(), has_value).is_end()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<T> to_vector() {
+        std::vector<T> v;
+        for (auto it = begin(); it != end(); ++it) {
+            v.push_back(*it);
+        }
+        return v;
+    }
+
+    class consistent_iterator {
+    private:
+        friend class sharded_consistent_linked_list<T>;
+
+        sharded_consistent_linked_list<T> *base_list;
+        std::vector<segment_iterator> cur;
+        std::vector<segment_iterator> ends;
+        // Index of the shard holding the current element, shards.size() at the end.
+        size_t shard = 0;
+
+        bool at_end(size_t i) {
+            return cur[i] == ends[i];
+        }
+
+        void select_shard() {
+            size_t n = cur.size();
+            if (base_list->order == shard_order::relaxed) {
+                while (shard < n && at_end(shard)) {
+                    shard++;
+                }
+                return;
+            }
+
+            shard = n;
+            size_t min_stamp = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (at_end(i)) {
+                    continue;
+                }
+                size_t stamp = (*cur[i]).stamp;
+                if (shard == n || stamp < min_stamp) {
+                    shard = i;
+                    min_stamp = stamp;
+                }
+            }
+        }
+
+    public:
+        consistent_iterator(sharded_consistent_linked_list<T> *base_list_, bool is_end) :
+                base_list(base_list_) {
+            for (auto &s : base_list->shards) {
+                cur.push_back(is_end ? s->end() : s->begin());
+                ends.push_back(s->end());
+            }
+            shard = 0;
+            select_shard();
+        }
+
+        T operator*() {
+            if (shard == cur.size()) {
+                throw consistent_linked_list_exception("No more element.");
+            }
+            return (*cur[shard]).value;
+        }
+
+        // Global push order of the current element, 0 in relaxed mode.
+        size_t stamp() {
+            if (shard == cur.size()) {
+                throw consistent_linked_list_exception("No more element.");
+            }
+            return (*cur[shard]).stamp;
+        }
+
+        consistent_iterator &operator++() {
+            if (shard == cur.size()) {
+                throw consistent_linked_list_exception("No more element.");
+            }
+            ++cur[shard];
+            select_shard();
+            return *this;
+        }
+
+        bool operator==(const consistent_iterator &rhs) const {
+            if (shard != rhs.shard) {
+                return false;
+            }
+            return shard == cur.size() || cur[shard] == rhs.cur[shard];
+        }
+
+        bool operator!=(const consistent_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+};
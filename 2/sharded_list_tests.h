@@ -0,0 +1,133 @@
+#pragma once
+
+#include "iostream"
+#include "vector"
+#include <thread>
+
+#include "sharded_consistent_linked_list.h"
+
+namespace sharded_list_tests {
+    using namespace std;
+
+    const int N_TEST = 100;
+    int N_THREADS = 4;
+
+    string test_case = "NULL";
+
+    void REQUIRE(bool b) {
+        if (!b) {
+            throw runtime_error("Fail. Test: " + test_case);
+        }
+    }
+
+    void push_relaxed() {
+        test_case = "push_relaxed";
+
+        sharded_consistent_linked_list<int> list(N_THREADS, shard_order::relaxed);
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    list.push_back(i * N_TEST + j);
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(list.size() == (size_t) (N_THREADS * N_TEST));
+
+        auto v = list.to_vector();
+        REQUIRE(v.size() == (size_t) (N_THREADS * N_TEST));
+        sort(v.begin(), v.end());
+        for (int i = 0; i < N_THREADS * N_TEST; ++i) {
+            REQUIRE(v[i] == i);
+        }
+    }
+
+    void push_ordered() {
+        test_case = "push_ordered";
+
+        // Fewer shards than threads, so threads share shards, and enough
+        // pushes for a thread to lose the shard lock between stamp and link.
+        const int N_PUSHES = 100 * N_TEST;
+        sharded_consistent_linked_list<int> list(N_THREADS / 2, shard_order::ordered);
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_PUSHES; ++j) {
+                    list.push_back(i * N_PUSHES + j);
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        // The merge is in timestamp order.
+        size_t last_stamp = 0;
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            REQUIRE(it.stamp() >= last_stamp);
+            last_stamp = it.stamp();
+        }
+
+        // Values pushed by one thread must keep their order after the merge.
+        auto v = list.to_vector();
+        REQUIRE(v.size() == size_t(N_THREADS * N_PUSHES));
+        vector<int> last(N_THREADS, -1);
+        for (int x : v) {
+            int owner = x / N_PUSHES;
+            REQUIRE(x > last[owner]);
+            last[owner] = x;
+        }
+    }
+
+    void single_thread_order() {
+        test_case = "single_thread_order";
+
+        sharded_consistent_linked_list<int> list(N_THREADS, shard_order::ordered);
+        vector<int> v;
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+            v.push_back(i);
+        }
+        REQUIRE(list.to_vector() == v);
+    }
+
+    void erase() {
+        test_case = "erase";
+
+        sharded_consistent_linked_list<int> list(N_THREADS, shard_order::ordered);
+        REQUIRE(list.empty());
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+        }
+        REQUIRE(list.contain(N_TEST / 2));
+
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            if (*it % 2 == 0) {
+                list.erase(it);
+            }
+        }
+
+        REQUIRE(list.size() == N_TEST / 2);
+        REQUIRE(!list.contain(N_TEST / 2));
+        for (int x : list.to_vector()) {
+            REQUIRE(x % 2 == 1);
+        }
+    }
+
+    void start() {
+        push_relaxed();
+        push_ordered();
+        single_thread_order();
+        erase();
+
+        std::cout << "Sharded list tests passed. Nice!" << endl;
+    }
+}
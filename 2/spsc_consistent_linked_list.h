@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "consistent_linked_list.h"
+
+// consistent_linked_list for exactly one thread calling push_back and one
+// thread calling everything else. push_back and pop_first never wait: the
+// two threads only meet on next pointers and the push/pop counters, using
+// acquire/release atomics.
+template<typename T>
+class spsc_consistent_linked_list {
+private:
+    class Node {
+    public:
+        Node() = default;
+
+        explicit Node(const T &t) : value(t) {}
+
+        T value = T();
+        std::atomic<Node *> next{nullptr};
+
+        // Consumer side only, so no atomics needed.
+        bool is_deleted = false;
+        int ref_count = 0;
+    };
+
+    // Producer side.
+    alignas(64) Node *tail;
+    std::atomic<size_t> n_pushed{0};
+
+    // Consumer side. head is a dummy: the live elements start at head->next.
+    alignas(64) Node *head;
+    std::atomic<size_t> n_popped{0};
+
+    // A popped node goes as soon as no iterator holds it. head stays, the
+    // producer may still link behind it. Nobody follows the next of a popped
+    // node, iterators on one go on from head.
+    void release_node(Node *node) {
+        if (node->is_deleted && node->ref_count == 0 && node != head) {
+            delete node;
+            n_deleted_node++;
+        }
+    }
+
+public:
+    size_t n_deleted_node = 0;
+
+    class consistent_iterator;
+
+    spsc_consistent_linked_list() {
+        head = tail = new Node();
+        head->is_deleted = true;
+    }
+
+    ~spsc_consistent_linked_list() {
+        while (head != nullptr) {
+            Node *next = head->next.load(std::memory_order_relaxed);
+            delete head;
+            head = next;
+        }
+    }
+
+    // Producer.
+    void push_back(const T &value) {
+        Node *new_node = new Node(value);
+        // Counted before it is visible, so size() never sees more pops than pushes.
+        n_pushed.fetch_add(1, std::memory_order_relaxed);
+        tail->next.store(new_node, std::memory_order_release);
+        tail = new_node;
+    }
+
+    // Consumer.
+    std::optional<T> pop_first_value() {
+        Node *next = head->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return std::nullopt;
+        }
+        T res = next->value;
+        next->is_deleted = true;
+        Node *old = head;
+        head = next;
+        n_popped.fetch_add(1, std::memory_order_release);
+        release_node(old);
+        return res;
+    }
+
+    void pop_first() {
+        pop_first_value();
+    }
+
+    T front() {
+        Node *next = head->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            throw consistent_linked_list_exception("List size is 0.");
+        }
+        return next->value;
+    }
+
+    bool empty() {
+        return head->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    size_t size() {
+        size_t popped = n_popped.load(std::memory_order_acquire);
+        return n_pushed.load(std::memory_order_acquire) - popped;
+    }
+
+    consistent_iterator begin() {
+        return consistent_iterator(this, head->next.load(std::memory_order_acquire));
+    }
+
+    consistent_iterator end() {
+        return consistent_iterator(this, nullptr);
+    }
+
+    std::vector<T> to_vector() {
+        std::vector<T> v;
+        for (auto it = begin(); it != end(); ++it) {
+            v.push_back(*it);
+        }
+        return v;
+    }
+
+    // Consumer side only. Elements pushed after the iterator reached end()
+    // are not visited by it.
+    class consistent_iterator {
+    private:
+        spsc_consistent_linked_list<T> *base_list;
+        Node *node;
+
+        void acquire(Node *node_) {
+            node = node_;
+            if (node != nullptr) {
+                node->ref_count++;
+            }
+        }
+
+        void release() {
+            if (node != nullptr) {
+                node->ref_count--;
+                base_list->release_node(node);
+            }
+        }
+
+    public:
+        consistent_iterator(spsc_consistent_linked_list<T> *base_list_, Node *node_) : base_list(base_list_) {
+            acquire(node_);
+        }
+
+        consistent_iterator(const consistent_iterator &original) :
+                consistent_iterator(original.base_list, original.node) {}
+
+        ~consistent_iterator() {
+            release();
+        }
+
+        T operator*() {
+            if (node == nullptr) {
+                throw consistent_linked_list_exception("No more element.");
+            }
+            return node->value;
+        }
+
+        bool is_deleted() const {
+            return node != nullptr && node->is_deleted;
+        }
+
+        consistent_iterator &operator++() {
+            if (node == nullptr) {
+                throw consistent_linked_list_exception("No more element.");
+            }
+            // Everything up to head has been popped already.
+            Node *from = node->is_deleted ? base_list->head : node;
+            Node *old = node;
+            acquire(from->next.load(std::memory_order_acquire));
+            old->ref_count--;
+            base_list->release_node(old);
+            return *this;
+        }
+
+        bool operator==(const consistent_iterator &rhs) const {
+            return node == rhs.node;
+        }
+
+        bool operator!=(const consistent_iterator &rhs) const {
+            return node != rhs.node;
+        }
+    };
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "iostream"
+#include "vector"
+#include <thread>
+
+#include "spsc_consistent_linked_list.h"
+
+namespace spsc_list_tests {
+    using namespace std;
+
+    const int N_TEST = 100;
+
+    string test_case = "NULL";
+
+    void REQUIRE(bool b) {
+        if (!b) {
+            throw runtime_error("Fail. Test: " + test_case);
+        }
+    }
+
+    void push_and_pop() {
+        test_case = "push_and_pop";
+
+        spsc_consistent_linked_list<int> list;
+        REQUIRE(list.empty());
+        REQUIRE(!list.pop_first_value());
+
+        vector<int> v;
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+            v.push_back(i);
+            REQUIRE(list.size() == (size_t) (i + 1));
+        }
+        REQUIRE(list.to_vector() == v);
+
+        for (int i = 0; i < N_TEST; ++i) {
+            REQUIRE(list.front() == i);
+            auto value = list.pop_first_value();
+            REQUIRE(value && *value == i);
+        }
+        REQUIRE(list.empty());
+        REQUIRE(list.n_deleted_node == N_TEST);
+    }
+
+    void iterator_pins_popped() {
+        test_case = "iterator_pins_popped";
+
+        spsc_consistent_linked_list<int> list;
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(i);
+        }
+
+        auto it = list.begin();
+        ++it;
+        for (int i = 0; i < N_TEST / 2; ++i) {
+            list.pop_first();
+        }
+        // Node 1 is a tombstone now. Everything else popped is freed but
+        // node N_TEST / 2 - 1, the dummy head.
+        REQUIRE(it.is_deleted());
+        REQUIRE(*it == 1);
+        REQUIRE(list.n_deleted_node == N_TEST / 2 - 1);
+
+        ++it;
+        REQUIRE(*it == N_TEST / 2);
+        REQUIRE(list.n_deleted_node == N_TEST / 2);
+
+        list.push_back(N_TEST);
+        int expected = N_TEST / 2;
+        for (; it != list.end(); ++it) {
+            REQUIRE(*it == expected++);
+        }
+        REQUIRE(expected == N_TEST + 1);
+
+        // Steady push/pop under a parked iterator frees all but its node.
+        auto parked = list.begin();
+        size_t deleted = list.n_deleted_node;
+        for (int i = 0; i < N_TEST * N_TEST; ++i) {
+            list.push_back(i);
+            list.pop_first();
+        }
+        REQUIRE(list.n_deleted_node == deleted + N_TEST * N_TEST - 1);
+        REQUIRE(*parked == N_TEST / 2);
+        ++parked;
+        REQUIRE(*parked == N_TEST * N_TEST - N_TEST / 2 - 1);
+    }
+
+    void producer_consumer() {
+        test_case = "producer_consumer";
+
+        spsc_consistent_linked_list<int> list;
+        const int N = 100 * N_TEST;
+
+        thread producer([&]() -> void {
+            for (int i = 0; i < N; ++i) {
+                list.push_back(i);
+            }
+        });
+
+        bool ordered = true;
+        thread consumer([&]() -> void {
+            int expected = 0;
+            while (expected < N) {
+                auto v = list.pop_first_value();
+                if (!v) {
+                    this_thread::yield();
+                    continue;
+                }
+                ordered = ordered && *v == expected;
+                expected++;
+            }
+        });
+
+        producer.join();
+        consumer.join();
+
+        REQUIRE(ordered);
+        REQUIRE(list.empty());
+        REQUIRE(list.size() == 0);
+    }
+
+    void start() {
+        push_and_pop();
+        iterator_pins_popped();
+        producer_consumer();
+
+        std::cout << "SPSC list tests passed. Nice!" << endl;
+    }
+}
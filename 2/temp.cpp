@@ -3,6 +3,12 @@
 
 #include "func_tests.h"
 #include "thread_with_lock_list_tests.h"
+#include "sharded_list_tests.h"
+#include "flat_combining_list_tests.h"
+#include "elimination_list_tests.h"
+#include "async_list_tests.h"
+#include "spsc_list_tests.h"
+#include "mpsc_list_tests.h"
 
 using namespace std;
 
@@ -11,6 +17,12 @@ int main() {
 
     func_tests::start();
     threads_with_lock_list_tests::start();
+    sharded_list_tests::start();
+    flat_combining_list_tests::start();
+    elimination_list_tests::start();
+    async_list_tests::start();
+    spsc_list_tests::start();
+    mpsc_list_tests::start();
 
     return 0;
 }
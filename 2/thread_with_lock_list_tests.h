@@ -168,7 +168,7 @@ namespace threads_with_lock_list_tests {
         test_case = "erase";
 
         vector<int> numbers(N_THREADS * N_TEST);
-        for (int i = 0; i < numbers.size(); ++i) {
+        for (size_t i = 0; i < numbers.size(); ++i) {
             numbers[i] = i;
         }
         consistent_linked_list<int> list(numbers);
@@ -192,6 +192,483 @@ namespace threads_with_lock_list_tests {
         REQUIRE(list.size(), 0);
     }
 
+    void wait_pop_first() {
+        test_case = "wait_pop_first";
+
+        consistent_linked_list<int> list;
+        vector<long long> sums(N_THREADS, 0);
+
+        vector<thread> consumers(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            consumers[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    sums[i] += list.wait_pop_first();
+                }
+            });
+        }
+
+        thread producer([&]() -> void {
+            for (int j = 0; j < N_THREADS * N_TEST; ++j) {
+                list.push_back(j);
+            }
+        });
+
+        producer.join();
+        for (int i = 0; i < N_THREADS; ++i) {
+            consumers[i].join();
+        }
+
+        long long total = 0;
+        for (long long s : sums) {
+            total += s;
+        }
+        long long n = N_THREADS * N_TEST;
+        REQUIRE(total == n * (n - 1) / 2);
+        REQUIRE(list.empty());
+        REQUIRE(!list.pop_for(chrono::milliseconds(1)));
+    }
+
+    void bounded_push() {
+        test_case = "bounded_push";
+
+        const int CAPACITY = 4;
+        consistent_linked_list<int> list;
+        list.set_capacity(CAPACITY);
+
+        bool overflow = false;
+        thread producer([&]() -> void {
+            for (int j = 0; j < N_THREADS * N_TEST; ++j) {
+                list.push_back(j);
+                if (list.size() > CAPACITY) {
+                    overflow = true;
+                }
+            }
+        });
+
+        vector<int> popped;
+        thread consumer([&]() -> void {
+            for (int j = 0; j < N_THREADS * N_TEST; ++j) {
+                popped.push_back(list.wait_pop_first());
+            }
+        });
+
+        producer.join();
+        consumer.join();
+
+        REQUIRE(!overflow);
+        REQUIRE(list.empty());
+        for (int j = 0; j < N_THREADS * N_TEST; ++j) {
+            REQUIRE(popped[j] == j);
+        }
+    }
+
+    template<typename List>
+    void push_and_pop(List &list) {
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    list.push_back(j);
+                    if (i % 2) {
+                        list.pop_first();
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+    }
+
+    void policies() {
+        test_case = "policies";
+
+        consistent_linked_list<int, spin_lock, atomic_ref_count> spin_list;
+        push_and_pop(spin_list);
+        REQUIRE(spin_list.size(), (N_THREADS / 2) * N_TEST);
+
+        consistent_linked_list<int, shared_mutex_lock> shared_list;
+        push_and_pop(shared_list);
+        REQUIRE(shared_list.size(), (N_THREADS / 2) * N_TEST);
+
+        consistent_linked_list<int, adaptive_lock> adaptive_list;
+        push_and_pop(adaptive_list);
+        REQUIRE(adaptive_list.size(), (N_THREADS / 2) * N_TEST);
+
+        consistent_linked_list<int, ticket_lock> ticket_list;
+        push_and_pop(ticket_list);
+        REQUIRE(ticket_list.size(), (N_THREADS / 2) * N_TEST);
+
+        consistent_linked_list<int, mcs_lock> mcs_list;
+        push_and_pop(mcs_list);
+        REQUIRE(mcs_list.size(), (N_THREADS / 2) * N_TEST);
+
+        consistent_linked_list<int, contention_adaptive_lock> contention_list;
+        push_and_pop(contention_list);
+        REQUIRE(contention_list.size(), (N_THREADS / 2) * N_TEST);
+
+        consistent_linked_list<int, mutex_lock, plain_ref_count, huge_page_arena> arena_list;
+        push_and_pop(arena_list);
+        REQUIRE(arena_list.size(), (N_THREADS / 2) * N_TEST);
+    }
+
+    template<typename Lock>
+    void check_lock() {
+        Lock lock;
+        int counter = 0;
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    if (j % 2 == 0) {
+                        lock.lock();
+                    } else {
+                        while (!lock.try_lock()) {
+                            this_thread::yield();
+                        }
+                    }
+                    counter++;
+                    lock.unlock();
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(counter, N_THREADS * N_TEST);
+    }
+
+    void raw_locks() {
+        test_case = "raw_locks";
+        check_lock<spin_lock>();
+        check_lock<adaptive_lock>();
+        check_lock<ticket_lock>();
+        check_lock<mcs_lock>();
+        check_lock<contention_adaptive_lock>();
+    }
+
+    void adaptive_modes() {
+        test_case = "adaptive_modes";
+        consistent_linked_list<int, contention_adaptive_lock> list;
+        for (int i = 0; i < N_TEST; ++i) {
+            list.push_back(-1);
+        }
+        auto it = list.begin();
+        list.pop_first();
+
+        vector<lock_mode> modes = {lock_mode::reader_writer, lock_mode::spin_then_park, lock_mode::mutex};
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    if (i == 0) {
+                        list.get_lock_policy().switch_to(modes[j % 3]);
+                    } else if (i % 2) {
+                        list.push_back(j);
+                        list.pop_first();
+                    } else {
+                        list.contain(j);
+                        list.size();
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(list.size(), N_TEST - 1);
+        REQUIRE(*it, -1);
+        ++it;
+        REQUIRE(it != list.end());
+        REQUIRE(list.get_lock_policy().switches() >= 2);
+    }
+
+    void lock_adapts() {
+        test_case = "lock_adapts";
+        contention_adaptive_lock lock;
+
+        // Readers sleeping under the lock make sure they collide.
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&]() -> void {
+                for (int j = 0; j < 10 * N_TEST; ++j) {
+                    lock.lock_shared();
+                    this_thread::sleep_for(chrono::microseconds(5));
+                    lock.unlock_shared();
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(lock.mode() == lock_mode::reader_writer);
+    }
+
+    void busy_list() {
+        test_case = "busy_list";
+        consistent_linked_list<int> list;
+        list.push_back(1);
+        auto it = list.begin();
+
+        mutex m;
+        condition_variable cv;
+        bool locked = false;
+        bool done = false;
+        thread holder([&]() -> void {
+            list.get_lock_policy().lock();
+            unique_lock<mutex> lock(m);
+            locked = true;
+            cv.notify_all();
+            cv.wait(lock, [&] { return done; });
+            list.get_lock_policy().unlock();
+        });
+
+        {
+            unique_lock<mutex> lock(m);
+            cv.wait(lock, [&] { return locked; });
+        }
+
+        int v;
+        optional<consistent_linked_list<int>::consistent_iterator> found;
+        REQUIRE(list.try_push_back(2) == list_status::busy);
+        REQUIRE(list.try_pop_first(v) == list_status::busy);
+        REQUIRE(list.try_pop_last_for(v, chrono::milliseconds(1)) == list_status::timeout);
+        REQUIRE(list.try_erase(1) == list_status::busy);
+        REQUIRE(list.try_find_for(1, found, chrono::milliseconds(1)) == list_status::timeout);
+        REQUIRE(!found);
+        REQUIRE(it.try_advance() == list_status::busy);
+        REQUIRE(list.push_back_for(2, chrono::milliseconds(1)) == list_status::timeout);
+        REQUIRE(!list.pop_for(chrono::milliseconds(1)));
+
+        {
+            lock_guard<mutex> lock(m);
+            done = true;
+        }
+        cv.notify_all();
+        holder.join();
+
+        REQUIRE(list.try_pop_first(v) == list_status::ok && v == 1);
+        REQUIRE(list.size(), 0);
+    }
+
+    void compound_ops() {
+        test_case = "compound_ops";
+        consistent_linked_list<int> list;
+
+        // Every value gets inserted by exactly one thread and popped once.
+        vector<int> inserted(N_THREADS, 0);
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 0; j < N_TEST; ++j) {
+                    inserted[i] += list.insert_if_absent(j);
+                }
+            });
+        }
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        int total = 0;
+        for (int n : inserted) {
+            total += n;
+        }
+        REQUIRE(total, N_TEST);
+
+        vector<int> popped(N_THREADS, 0);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                while (true) {
+                    auto v = i % 2 ? list.pop_first_value() : list.pop_last_value();
+                    if (!v) {
+                        break;
+                    }
+                    popped[i]++;
+                }
+            });
+        }
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        total = 0;
+        for (int n : popped) {
+            total += n;
+        }
+        REQUIRE(total, N_TEST);
+    }
+
+    void positional_insert() {
+        test_case = "positional_insert";
+        consistent_linked_list<int> list;
+        list.push_back(0);
+        auto middle = list.begin();
+
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                for (int j = 1; j <= N_TEST; ++j) {
+                    if (i == 0) {
+                        list.insert_before(middle, -j);
+                    } else if (i == 1) {
+                        list.insert_after(middle, j);
+                    } else {
+                        list.push_back(N_TEST + 1);
+                        list.pop_last();
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        auto v = list.to_vector();
+        REQUIRE(v.size(), 2 * N_TEST + 1);
+        // Every insert lands right next to middle, so both halves come out reversed.
+        REQUIRE(is_sorted(v.begin(), v.begin() + N_TEST, greater<int>()));
+        REQUIRE(is_sorted(v.begin() + N_TEST + 1, v.end(), greater<int>()));
+        REQUIRE(v[N_TEST], 0);
+    }
+
+    void splice_both_ways() {
+        test_case = "splice_both_ways";
+        consistent_linked_list<int> a;
+        consistent_linked_list<int> b;
+        for (int i = 0; i < N_TEST; ++i) {
+            a.push_back(i);
+            b.push_back(N_TEST + i);
+        }
+        auto it = a.begin();
+
+        // Opposite splices lock the same two lists, in address order.
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                consistent_linked_list<int> &to = i % 2 ? a : b;
+                consistent_linked_list<int> &from = i % 2 ? b : a;
+                for (int j = 0; j < N_TEST; ++j) {
+                    if (i < 2) {
+                        auto first = from.begin();
+                        auto second = first;
+                        if (second.move_next()) {
+                            second.move_next();
+                        }
+                        to.splice(to.end(), from, first, second);
+                    } else {
+                        // Walkers get carried along to the other list.
+                        auto walker = from.begin();
+                        while (walker.move_next()) {}
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+
+        REQUIRE(a.size() + b.size(), 2 * N_TEST);
+        auto all = a.to_vector();
+        auto rest = b.to_vector();
+        all.insert(all.end(), rest.begin(), rest.end());
+        sort(all.begin(), all.end());
+        for (int i = 0; i < 2 * N_TEST; ++i) {
+            REQUIRE(all[i], i);
+        }
+        while (it.move_next()) {}
+        REQUIRE(it.is_end());
+    }
+
+    void insert_while_spliced() {
+        test_case = "insert_while_spliced";
+        consistent_linked_list<int> a;
+        consistent_linked_list<int> b;
+        a.set_capacity(2);
+        a.push_back(1);
+        a.push_back(2);
+        auto it = a.begin();
+        it.move_next();
+
+        // The insert waits for room, which the splice makes by taking its node.
+        bool threw = false;
+        thread inserter([&]() -> void {
+            try {
+                a.insert_before(it, 42);
+            } catch (const consistent_linked_list_exception &) {
+                threw = true;
+            }
+        });
+        this_thread::sleep_for(chrono::milliseconds(10));
+        b.splice(b.end(), a, it, a.end());
+        inserter.join();
+
+        REQUIRE(threw);
+        REQUIRE(a.to_vector() == vector<int>{1});
+        REQUIRE(b.to_vector() == vector<int>{2});
+    }
+
+    void erase_all() {
+        test_case = "erase_all";
+
+        vector<int> numbers(N_THREADS * N_TEST);
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            numbers[i] = i;
+        }
+        consistent_linked_list<int> list(numbers);
+
+        vector<size_t> erased(N_THREADS);
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                vector<int> slice(numbers.begin() + i * N_TEST, numbers.begin() + (i + 1) * N_TEST);
+                erased[i] = list.erase_all(slice);
+            });
+        }
+
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+            REQUIRE(erased[i], N_TEST);
+        }
+
+        REQUIRE(list.size(), 0);
+    }
+
+    void replace_while_reading() {
+        test_case = "replace_while_reading";
+        consistent_linked_list<string> list;
+        list.push_back(string(64, 'a'));
+        auto it = list.begin();
+
+        // Long strings, so a torn copy would show up as mixed letters.
+        vector<thread> vt(N_THREADS);
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i] = thread([&, i]() -> void {
+                auto mine = list.begin();
+                for (int j = 0; j < N_TEST * N_TEST; ++j) {
+                    if (i % 2) {
+                        list.replace(it, string(64, char('a' + j % 26)));
+                    } else {
+                        string v = *mine;
+                        REQUIRE(v == string(64, v[0]));
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < N_THREADS; ++i) {
+            vt[i].join();
+        }
+    }
+
     void start() {
         push_1();
         push_2();
@@ -199,6 +676,19 @@ namespace threads_with_lock_list_tests {
         pop_last();
         pop_first_and_last();
         erase();
+        wait_pop_first();
+        bounded_push();
+        policies();
+        raw_locks();
+        adaptive_modes();
+        lock_adapts();
+        busy_list();
+        compound_ops();
+        positional_insert();
+        splice_both_ways();
+        insert_while_spliced();
+        erase_all();
+        replace_while_reading();
 
         std::cout << "Threads tests with lock list passed. Nice!" << endl;
     }